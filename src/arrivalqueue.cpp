@@ -0,0 +1,106 @@
+/*
+    Copyright (C) 2012 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "arrivalqueue.h"
+#include "requestball.h"
+
+#include <algorithm>
+
+ArrivalQueue::ArrivalQueue() {
+}
+
+ArrivalQueue::~ArrivalQueue() {
+    clear();
+}
+
+void ArrivalQueue::swapArrivals(size_t a, size_t b) {
+    std::swap(heap[a], heap[b]);
+
+    heap[a].ball->queue_index = a;
+    heap[b].ball->queue_index = b;
+}
+
+void ArrivalQueue::moveUp(size_t i) {
+    while(i > 0 && heap[(i-1)/2].time > heap[i].time) {
+        swapArrivals(i, (i-1)/2);
+        i = (i-1)/2;
+    }
+}
+
+void ArrivalQueue::moveDown(size_t i) {
+
+    size_t no_arrivals = heap.size();
+
+    for(;;) {
+        size_t soonest = i;
+        size_t left    = i*2 + 1;
+        size_t right   = left + 1;
+
+        if(left  < no_arrivals && heap[left].time  < heap[soonest].time) soonest = left;
+        if(right < no_arrivals && heap[right].time < heap[soonest].time) soonest = right;
+
+        if(soonest == i) break;
+
+        swapArrivals(i, soonest);
+        i = soonest;
+    }
+}
+
+void ArrivalQueue::push(RequestBall* ball, double time) {
+    Arrival arrival;
+    arrival.time = time;
+    arrival.ball = ball;
+
+    ball->queue       = this;
+    ball->queue_index = heap.size();
+
+    heap.push_back(arrival);
+
+    moveUp(heap.size()-1);
+}
+
+void ArrivalQueue::pop() {
+    remove(heap[0].ball);
+}
+
+void ArrivalQueue::remove(RequestBall* ball) {
+
+    size_t i    = ball->queue_index;
+    size_t last = heap.size()-1;
+
+    if(i != last) {
+        swapArrivals(i, last);
+    }
+
+    heap.pop_back();
+
+    ball->queue       = 0;
+    ball->queue_index = 0;
+
+    if(i < heap.size()) {
+        moveUp(i);
+        moveDown(i);
+    }
+}
+
+void ArrivalQueue::clear() {
+    for(std::vector<Arrival>::iterator it = heap.begin(); it != heap.end(); it++) {
+        it->ball->queue       = 0;
+        it->ball->queue_index = 0;
+    }
+    heap.clear();
+}
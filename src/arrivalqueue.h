@@ -0,0 +1,59 @@
+/*
+    Copyright (C) 2012 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ARRIVAL_QUEUE_H
+#define ARRIVAL_QUEUE_H
+
+#include <stdlib.h>
+#include <vector>
+
+class RequestBall;
+
+//balls heading for a paddle in order of when they will arrive (a min-heap).
+//a ball's arrival time is fixed when it is added, as it moves at a constant
+//speed. each ball records its queue and position so it can be taken out early.
+
+class ArrivalQueue {
+
+    struct Arrival {
+        double time;
+        RequestBall* ball;
+    };
+
+    std::vector<Arrival> heap;
+
+    void moveUp(size_t i);
+    void moveDown(size_t i);
+    void swapArrivals(size_t a, size_t b);
+public:
+    ArrivalQueue();
+    ~ArrivalQueue();
+
+    void push(RequestBall* ball, double time);
+    void pop();
+    void remove(RequestBall* ball);
+
+    //the ball arriving soonest
+    RequestBall* top() const { return heap[0].ball; }
+
+    bool empty() const  { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+
+    void clear();
+};
+
+#endif
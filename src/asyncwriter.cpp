@@ -0,0 +1,114 @@
+/*
+    Copyright (C) 2012 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "asyncwriter.h"
+
+extern "C" {
+static int async_writer_thread(void *arg) {
+    AsyncWriter *w = static_cast<AsyncWriter *>(arg);
+
+    w->writeThr();
+
+    return 0;
+}
+};
+
+AsyncWriter::AsyncWriter(std::string filename) {
+
+    file = fopen(filename.c_str(), "a");
+
+    if(file == 0) {
+        throw AsyncWriterException(filename);
+    }
+
+    dropped  = 0;
+    finished = false;
+
+    pending.reserve(ASYNC_WRITER_FLUSH_SIZE);
+
+    cond   = SDL_CreateCond();
+    mutex  = SDL_CreateMutex();
+    thread = SDL_CreateThread( async_writer_thread, this );
+}
+
+AsyncWriter::~AsyncWriter() {
+
+    SDL_mutexP(mutex);
+
+        finished = true;
+
+    SDL_CondSignal(cond);
+    SDL_mutexV(mutex);
+
+    //thread writes anything still pending before it exits
+    SDL_WaitThread(thread, 0);
+
+    SDL_DestroyCond(cond);
+    SDL_DestroyMutex(mutex);
+
+    fclose(file);
+
+    if(dropped > 0) debugLog("async writer dropped %d lines\n", dropped);
+}
+
+void AsyncWriter::writeLine(const std::string& line) {
+
+    SDL_mutexP(mutex);
+
+    if(pending.size() + line.size() >= ASYNC_WRITER_MAX_PENDING) {
+        dropped++;
+    } else {
+        pending += line;
+        pending += '\n';
+
+        if(pending.size() >= ASYNC_WRITER_FLUSH_SIZE) {
+            SDL_CondSignal(cond);
+        }
+    }
+
+    SDL_mutexV(mutex);
+}
+
+void AsyncWriter::writeThr() {
+
+    SDL_mutexP(mutex);
+
+    for (;;) {
+        //write out whatever has accumulated at least once a second
+        if(!finished && pending.size() < ASYNC_WRITER_FLUSH_SIZE) {
+            SDL_CondWaitTimeout(cond, mutex, 1000);
+        }
+
+        bool exiting = finished;
+
+        writing.swap(pending);
+
+        SDL_mutexV(mutex);
+
+            if(!writing.empty()) {
+                fwrite(writing.data(), 1, writing.size(), file);
+                fflush(file);
+                writing.clear();
+            }
+
+        SDL_mutexP(mutex);
+
+        if(exiting) break;
+    }
+
+    SDL_mutexV(mutex);
+}
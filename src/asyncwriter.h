@@ -0,0 +1,69 @@
+/*
+    Copyright (C) 2012 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ASYNC_WRITER_H
+#define ASYNC_WRITER_H
+
+#include <stdio.h>
+#include <string>
+
+#include "SDL_thread.h"
+
+#include "core/sdlapp.h"
+
+//buffer size at which the writer thread is woken early
+#define ASYNC_WRITER_FLUSH_SIZE 65536
+
+//lines are dropped rather than blocking once this much is waiting
+#define ASYNC_WRITER_MAX_PENDING 16777216
+
+class AsyncWriterException : public std::exception {
+protected:
+    std::string filename;
+public:
+    AsyncWriterException(std::string& filename) : filename(filename) {}
+    virtual ~AsyncWriterException() throw () {};
+
+    virtual const char* what() const throw() { return filename.c_str(); }
+};
+
+//appends lines to a file from a background thread so the caller
+//only pays for copying the line into a buffer
+
+class AsyncWriter {
+
+    FILE* file;
+
+    std::string pending;
+    std::string writing;
+
+    int dropped;
+    bool finished;
+
+    SDL_Thread* thread;
+    SDL_mutex* mutex;
+    SDL_cond* cond;
+public:
+    AsyncWriter(std::string filename);
+    ~AsyncWriter();
+
+    void writeLine(const std::string& line);
+
+    void writeThr();
+};
+
+#endif
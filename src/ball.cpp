@@ -17,141 +17,58 @@
 
 #include "ball.h"
 
-//Line
-Line::Line(vec2f start, vec2f end) {
-	this->start = start;
-	this->end   = end;
-}
-
-Line::~Line() {
-}
-
-// check if line intersects the plane of another line
-
-bool Line::intersects(Line& l, vec2f *p) {
-    vec2f a = end   - start;
-    vec2f b = l.end - l.start;
-
-    float d = a.x*b.y - a.y * b.x;
-
-    //parallel test
-    if (!d) return false;
-
-    vec2f w = start - l.start;
-
-    //check if outside either line segment
-    float s = b.x * w.y - b.y * w.x;
-
-    float sd = s/d;
-    if (sd < 0.0f || sd > 1.0f) return false;
-
-    float t = a.x * w.y - a.y * w.x;
-
-    float td = t/d;
-    if (td < 0.0f || td > 1.0f) return false;
-
-    //calculate intersect
-    if(p != 0) *p = a * sd + start;
-
-    return true;
-}
-
 //Projected Ball
 ProjectedBall::ProjectedBall() {
+    slot = -1;
 }
 
 ProjectedBall::ProjectedBall(const vec2f& pos, const vec2f& vel, const vec3f& colour, int dest_x, float eta, float size, float speed) {
+    slot = -1;
     init(pos, vel, colour, dest_x, eta, size, speed);
 }
 
 void ProjectedBall::init(const vec2f& pos, const vec2f& vel, const vec3f& colour, int dest_x, float eta, float size, float speed) {
-    this->pos = pos;
-    this->vel = vel;
-    this->colour = colour;
-    this->speed = speed;
-    this->size  = size;
+
+    if(slot < 0) slot = ballstore.allocate(this);
+
+    ballstore.red[slot]   = colour.x;
+    ballstore.green[slot] = colour.y;
+    ballstore.blue[slot]  = colour.z;
+    ballstore.speed[slot] = speed;
+    ballstore.size[slot]  = size;
+    ballstore.eta[slot]   = eta;
 
     this->dest_x = dest_x;
-    this->start_x = (int) pos.x;
-    this->eta    = eta;
     this->has_bounced=0;
     no_bounce = 0;
 
-    project();
+    setPath(pos, vel);
 }
 
-
 ProjectedBall::~ProjectedBall() {
+    if(slot >= 0) ballstore.release(slot);
 }
 
-/*project path of the ball
-  as a series of line segments
-*/
+//travel from pos in direction dir, reaching dest_x after eta
+void ProjectedBall::setPath(const vec2f& pos, const vec2f& dir) {
+    vel = dir;
 
-void ProjectedBall::project() {
-    elapsed = 0.0f;
-    progress = 0.0f;
-    points.clear();
-    vec2f p = pos;
-    points.push_back(p);
-
-    //project current position and direction until it hits a wall or crosses dest_x
-    Line finish(vec2f(dest_x, 0), vec2f(dest_x, display.height));
-    Line top(vec2f(0,0), vec2f(display.width, 0));
-    Line bottom(vec2f(0,display.height), vec2f(display.width, display.height));
-
-    //project far enough to cross a side of the screen
-    float inc = display.width*2.0f;
-
-    bool finished=false;
-    vec2f currvel = vel;
-    total_length=0;
-    line_lengths.clear();
-
-    while(!finished) {
-        Line proj(p, p + currvel*inc);
-
-        /*
-        debugLog("proj = (%.2f, %.2f), (%.2f, %.2f)\n", proj.start.x, proj.start.y, proj.end.x, proj.end.y);
-        debugLog("finish = (%.2f, %.2f), (%.2f, %.2f)\n", finish.start.x, finish.start.y, finish.end.x, finish.end.y);
-        debugLog("top = (%.2f, %.2f), (%.2f, %.2f)\n", top.start.x, top.start.y, top.end.x, top.end.y);
-        debugLog("bottom = (%.2f, %.2f), (%.2f, %.2f)\n", bottom.start.x, bottom.start.y, bottom.end.x, bottom.end.y);
-        */
-
-        vec2f intersect;
-
-        //find nearest intersected plane
-
-        if(proj.intersects(finish, &intersect)) {
-            finished=true;
-        }
-        else if(proj.intersects(bottom, &intersect)) {
-            currvel.y = -currvel.y;
-            intersect.y -= 1.0f;
-        } else if(proj.intersects(top, &intersect)) {
-            currvel.y = -currvel.y;
-            intersect.y += 1.0f;
-        } else {
-            break;
-        }
-
-        float length = (intersect-p).length();
-
-        p = intersect;
-        points.push_back(intersect);
-        line_lengths.push_back(length);
-        total_length +=length;
-    }
+    float eta = ballstore.eta[slot];
+
+    float vx = (dest_x - pos.x) / eta;
+    float vy = (fabs(dir.x) > 0.0001f) ? dir.y * fabs(vx / dir.x) : 0.0f;
+
+    ballstore.setPath(slot, pos.x, pos.y, vx, vy);
 }
 
 bool ProjectedBall::isFinished() const {
-    return has_bounced && elapsed>=eta;
+    return has_bounced && arrived();
 }
 
 void ProjectedBall::bounce() {
     if(has_bounced) return;
 
-    pos = finish();
+    vec2f pos = finish();
 
     if(!no_bounce) {
         vel.x  = -vel.x;
@@ -160,79 +77,41 @@ void ProjectedBall::bounce() {
         dest_x = display.width;
     }
 
-    project();
+    setPath(pos, vel);
     has_bounced=true;
 }
 
 bool ProjectedBall::arrived() const {
-    return elapsed>=eta;
+    return ballstore.elapsed[slot] >= ballstore.eta[slot];
 }
 
-void ProjectedBall::setElapsed(float e) {
-    elapsed =e;
+int ProjectedBall::setElapsed(float e) {
+    return ballstore.setElapsed(slot, e);
 }
 
-float ProjectedBall::arrivalTime() {
-    return (eta-elapsed)/speed;
+float ProjectedBall::arrivalTime() const {
+    return (ballstore.eta[slot] - ballstore.elapsed[slot]) / ballstore.speed[slot];
 }
 
 float ProjectedBall::getProgress() const {
-    return progress;
+    return ballstore.elapsed[slot] / ballstore.eta[slot];
 }
 
 void ProjectedBall::dontBounce() {
     no_bounce=1;
 }
 
-void ProjectedBall::logic(float dt) {
-    elapsed += (dt * speed);
-    progress = elapsed / eta;
-
-    if(progress>1.0f) {
-        if(!has_bounced) {
-            bounce();
-            return;
-        }
-
-        return;
-    }
-
-    //number of lines
-    int nolines = points.size()-1;
-
-    //progress
-    float currposf = progress * total_length;
-
-    int pointno = 0;
-    float len=0;
+//where the ball crosses dest_x
+vec2f ProjectedBall::finish() const {
+    float eta = ballstore.eta[slot];
 
-    while(pointno<nolines && len+line_lengths[pointno]<currposf) {
-        len+=line_lengths[pointno];
-        pointno++;
-    }
-
-    if(pointno>=nolines) {
-
-        if(!has_bounced) {
-            bounce();
-            return;
-        }
-
-        return;
-    }
-
-    vec2f from = points[pointno];
-    vec2f to   = points[pointno+1];
-
-    float linepos = (currposf - len)/line_lengths[pointno];
-
-    this->pos = from + ((to-from)*linepos);
+    return vec2f(dest_x, ball_store_fold(ballstore.start_y[slot] + ballstore.vy[slot] * eta, display.height));
 }
 
-vec2f ProjectedBall::finish() {
-    return points[points.size()-1];
-}
+//position the ball was at the store's lag ago
+vec2f ProjectedBall::getDrawPos() const {
+    float elapsed = std::max(0.0f, ballstore.elapsed[slot] - ballstore.getLag() * ballstore.speed[slot]);
 
-float ProjectedBall::getX() {
-    return pos.x;
+    return vec2f(ballstore.start_x[slot] + ballstore.vx[slot] * elapsed,
+                 ball_store_fold(ballstore.start_y[slot] + ballstore.vy[slot] * elapsed, display.height));
 }
@@ -18,67 +18,56 @@
 #ifndef BALL_H
 #define BALL_H
 
-#include <vector>
-
 #include "core/vectors.h"
 #include "core/sdlapp.h"
 
-class Line {
+#include "ballstore.h"
 
-public:
-    vec2f start;
-    vec2f end;
-    Line(vec2f start, vec2f end);
-    ~Line();
-    bool intersects(Line& l, vec2f* p = 0);
-};
+//a ball travelling towards dest_x, bouncing off the top and bottom of the screen.
+//the position and motion are kept in the ball store, which moves all the balls
+//together; the ball holds its slot in the store.
 
 class ProjectedBall {
 
 protected:
-    std::vector<vec2f> points;
-    std::vector<float> line_lengths;
-    float total_length;
+    int slot;
     int dest_x;
-    int start_x;
-    float eta;
-    float elapsed;
-    float progress;
     bool has_bounced;
     bool no_bounce;
 
-public:
-    vec2f pos;
+    //direction of travel
     vec2f vel;
-    float size;
-    vec3f colour;
-    float speed;
 
+    void setPath(const vec2f& pos, const vec2f& dir);
+public:
     ProjectedBall();
     ProjectedBall(const vec2f& pos, const vec2f& vel, const vec3f& colour, int dest_x, float eta, float size, float speed = 10.0f);
     ~ProjectedBall();
 
     void init(const vec2f& pos, const vec2f& vel, const vec3f& colour, int dest_x, float eta, float size, float speed);
 
-    void setElapsed(float e);
-    void project();
-    vec2f finish();
+    //returns the number of requests moved onto the screen
+    int setElapsed(float e);
+    vec2f finish() const;
 
     void bounce();
-    
+
     void dontBounce();
 
-    float getX();
+    float getX() const        { return ballstore.x[slot]; }
+    vec2f getPos() const      { return vec2f(ballstore.x[slot], ballstore.y[slot]); }
+    vec2f getDrawPos() const;
+    vec3f getColour() const   { return vec3f(ballstore.red[slot], ballstore.green[slot], ballstore.blue[slot]); }
+    float getSize() const     { return ballstore.size[slot]; }
+    float getSpeed() const    { return ballstore.speed[slot]; }
 
     bool isFinished() const;
     bool hasBounced() const { return has_bounced; }
 
     bool arrived() const;
 
-    float arrivalTime();
+    float arrivalTime() const;
     float getProgress() const;
-
-    void logic(float dt);
 };
 
 #endif
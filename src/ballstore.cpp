@@ -0,0 +1,205 @@
+/*
+    Copyright (C) 2012 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ballstore.h"
+
+#include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "core/display.h"
+
+BallStore ballstore;
+
+float ball_store_fold(float y, float limit) {
+    float period = limit * 2.0f;
+
+    float offset = y - period * floorf(y / period);
+
+    return limit - fabsf(limit - offset);
+}
+
+BallStore::BallStore() {
+    live  = 0;
+    clock = 0.0;
+    lag   = 0.0f;
+}
+
+int BallStore::allocate(ProjectedBall* owner) {
+
+    if(free_slots.empty()) {
+        size_t first = owners.size();
+        size_t slots = first + BALL_STORE_BLOCK;
+
+        x.resize(slots, 0.0f);
+        y.resize(slots, 0.0f);
+        start_x.resize(slots, 0.0f);
+        start_y.resize(slots, 0.0f);
+        vx.resize(slots, 0.0f);
+        vy.resize(slots, 0.0f);
+        elapsed.resize(slots, 0.0f);
+        eta.resize(slots, 1.0f);
+        speed.resize(slots, 0.0f);
+        size.resize(slots, 0.0f);
+        weight.resize(slots, 1);
+        red.resize(slots, 0.0f);
+        green.resize(slots, 0.0f);
+        blue.resize(slots, 0.0f);
+        owners.resize(slots, 0);
+
+        //taken from the back, so hand out the lowest first
+        for(size_t i=slots;i>first;i--) {
+            free_slots.push_back(i-1);
+        }
+    }
+
+    int slot = free_slots.back();
+    free_slots.pop_back();
+
+    owners[slot] = owner;
+    weight[slot] = 1;
+    live++;
+
+    return slot;
+}
+
+//stationary with no speed, so never arrives or comes onto the screen
+void BallStore::release(int slot) {
+    start_x[slot] = x[slot];
+    start_y[slot] = y[slot];
+    vx[slot]      = 0.0f;
+    vy[slot]      = 0.0f;
+    elapsed[slot] = 0.0f;
+    eta[slot]     = 1.0f;
+    speed[slot]   = 0.0f;
+    owners[slot]  = 0;
+
+    free_slots.push_back(slot);
+    live--;
+}
+
+void BallStore::setPath(int slot, float start_x, float start_y, float vx, float vy) {
+    this->start_x[slot] = start_x;
+    this->start_y[slot] = start_y;
+    this->vx[slot]      = vx;
+    this->vy[slot]      = vy;
+
+    setElapsed(slot, 0.0f);
+}
+
+int BallStore::setElapsed(int slot, float elapsed) {
+    this->elapsed[slot] = elapsed;
+
+    float old_x = x[slot];
+
+    x[slot] = start_x[slot] + vx[slot] * elapsed;
+    y[slot] = ball_store_fold(start_y[slot] + vy[slot] * elapsed, display.height);
+
+    return (old_x < 0.0f && x[slot] >= 0.0f) ? weight[slot] : 0;
+}
+
+//a ball already on the screen was counted when it came on
+int BallStore::addWeight(int slot) {
+    weight[slot]++;
+
+    return x[slot] >= 0.0f ? 1 : 0;
+}
+
+int BallStore::update(float dt, std::vector<ProjectedBall*>& arrived) {
+
+    clock += dt;
+
+    size_t slots = owners.size();
+
+    if(slots == 0) return 0;
+
+    float height = display.height;
+
+    int appeared = 0;
+
+    float* px   = &x[0];
+    float* py   = &y[0];
+    float* psx  = &start_x[0];
+    float* psy  = &start_y[0];
+    float* pvx  = &vx[0];
+    float* pvy  = &vy[0];
+    float* pe   = &elapsed[0];
+    float* peta = &eta[0];
+    float* ps   = &speed[0];
+    int*   pw   = &weight[0];
+
+    size_t i = 0;
+
+#ifdef __SSE2__
+    __m128 vdt     = _mm_set1_ps(dt);
+    __m128 vzero   = _mm_setzero_ps();
+    __m128 vone    = _mm_set1_ps(1.0f);
+    __m128 vheight = _mm_set1_ps(height);
+    __m128 vperiod = _mm_set1_ps(height * 2.0f);
+    __m128 vinv    = _mm_set1_ps(1.0f / (height * 2.0f));
+    __m128 vsign   = _mm_set1_ps(-0.0f);
+
+    for(;i+4<=slots;i+=4) {
+        __m128 e = _mm_add_ps(_mm_loadu_ps(pe+i), _mm_mul_ps(vdt, _mm_loadu_ps(ps+i)));
+        _mm_storeu_ps(pe+i, e);
+
+        __m128 old_x = _mm_loadu_ps(px+i);
+        __m128 new_x = _mm_add_ps(_mm_loadu_ps(psx+i), _mm_mul_ps(_mm_loadu_ps(pvx+i), e));
+        _mm_storeu_ps(px+i, new_x);
+
+        //fold into the screen: offset into the period, then reflect the second half
+        __m128 unfolded = _mm_add_ps(_mm_loadu_ps(psy+i), _mm_mul_ps(_mm_loadu_ps(pvy+i), e));
+
+        __m128 periods = _mm_mul_ps(unfolded, vinv);
+        __m128 whole   = _mm_cvtepi32_ps(_mm_cvttps_epi32(periods));
+        whole = _mm_sub_ps(whole, _mm_and_ps(_mm_cmpgt_ps(whole, periods), vone));
+
+        __m128 offset = _mm_sub_ps(unfolded, _mm_mul_ps(whole, vperiod));
+        __m128 pos    = _mm_sub_ps(vheight, _mm_andnot_ps(vsign, _mm_sub_ps(vheight, offset)));
+
+        _mm_storeu_ps(py+i, pos);
+
+        int appear_mask = _mm_movemask_ps(_mm_and_ps(_mm_cmplt_ps(old_x, vzero), _mm_cmpge_ps(new_x, vzero)));
+        int arrive_mask = _mm_movemask_ps(_mm_cmpge_ps(e, _mm_loadu_ps(peta+i)));
+
+        for(int j=0;appear_mask != 0;j++, appear_mask >>= 1) {
+            if(appear_mask & 1) appeared += pw[i+j];
+        }
+
+        for(int j=0;arrive_mask != 0;j++, arrive_mask >>= 1) {
+            if(arrive_mask & 1) arrived.push_back(owners[i+j]);
+        }
+    }
+#endif
+
+    for(;i<slots;i++) {
+        pe[i] += dt * ps[i];
+
+        float old_x = px[i];
+
+        px[i] = psx[i] + pvx[i] * pe[i];
+        py[i] = ball_store_fold(psy[i] + pvy[i] * pe[i], height);
+
+        if(old_x < 0.0f && px[i] >= 0.0f) appeared += pw[i];
+
+        if(pe[i] >= peta[i]) arrived.push_back(owners[i]);
+    }
+
+    return appeared;
+}
@@ -0,0 +1,109 @@
+/*
+    Copyright (C) 2012 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BALL_STORE_H
+#define BALL_STORE_H
+
+#include <stdlib.h>
+#include <vector>
+
+//slots are added in blocks of this many so the arrays can be processed 4 at a time
+#define BALL_STORE_BLOCK 4
+
+class ProjectedBall;
+
+//state of every ball in flight kept as parallel arrays, so all the balls
+//can be moved in one pass over contiguous memory. released slots go on a
+//free list to be reused, and are left stationary.
+//
+//balls travel in straight lines reflected off the top and bottom of the
+//screen, so the position is worked out directly from where the ball was
+//at the start of its path and the time elapsed since.
+
+class BallStore {
+    std::vector<int> free_slots;
+    size_t live;
+
+    //time the balls have been moving for
+    double clock;
+
+    //time behind the simulation the balls are drawn at
+    float lag;
+public:
+    //current position
+    std::vector<float> x;
+    std::vector<float> y;
+
+    //position at the start of the path, and velocity in pixels per unit
+    //of elapsed time ignoring any reflections
+    std::vector<float> start_x;
+    std::vector<float> start_y;
+    std::vector<float> vx;
+    std::vector<float> vy;
+
+    //time elapsed since the start of the path, and the time to finish it
+    std::vector<float> elapsed;
+    std::vector<float> eta;
+
+    //rate at which elapsed time passes
+    std::vector<float> speed;
+
+    std::vector<float> size;
+
+    //number of requests the ball stands for
+    std::vector<int> weight;
+
+    std::vector<float> red;
+    std::vector<float> green;
+    std::vector<float> blue;
+
+    std::vector<ProjectedBall*> owners;
+
+    BallStore();
+
+    int  allocate(ProjectedBall* owner);
+    void release(int slot);
+
+    //start a new path from the ball's current position
+    void setPath(int slot, float start_x, float start_y, float vx, float vy);
+
+    //position of a ball after an amount of elapsed time. returns the
+    //number of requests this moved onto the screen, as update does
+    int setElapsed(int slot, float elapsed);
+
+    //add a request to a ball, returning the number moved onto the screen
+    int addWeight(int slot);
+
+    //move every ball on by dt seconds. balls reaching the end of their path
+    //are added to arrived. returns the number of requests that came onto the
+    //screen, by the weight of each ball.
+    int update(float dt, std::vector<ProjectedBall*>& arrived);
+
+    size_t getSlots() const { return owners.size(); }
+    size_t getLive() const  { return live; }
+    double getClock() const { return clock; }
+
+    void setLag(float lag)  { this->lag = lag; }
+    float getLag() const    { return lag; }
+};
+
+extern BallStore ballstore;
+
+//height reflected into the range 0 - limit, as if bouncing between the two (a triangle wave)
+float ball_store_fold(float y, float limit);
+
+#endif
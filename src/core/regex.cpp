@@ -27,6 +27,8 @@
 
 #include "regex.h"
 
+#include <string.h>
+
 Regex::Regex(const std::string& regex, bool test) {
 
     re = pcre_compile(
@@ -48,6 +50,11 @@ Regex::Regex(const std::string& regex, bool test) {
         valid = true;
     }
 
+    //limit the cost of pathological input
+    memset(&extra, 0, sizeof(pcre_extra));
+    extra.flags = PCRE_EXTRA_MATCH_LIMIT | PCRE_EXTRA_MATCH_LIMIT_RECURSION;
+    extra.match_limit           = REGEX_MATCH_LIMIT;
+    extra.match_limit_recursion = REGEX_MATCH_LIMIT_RECURSION;
 }
 
 Regex::~Regex() {
@@ -64,7 +71,7 @@ bool Regex::match(const std::string& str, std::vector<std::string>* results) {
 
     int rc = pcre_exec(
         re,
-        0,
+        &extra,
         str.c_str(),
         str.size(),
         0,
@@ -83,17 +90,18 @@ bool Regex::match(const std::string& str, std::vector<std::string>* results) {
 
         results->clear();
 
-        char* resbuff = new char[str.size()];
-
         for (int i = 1; i < rc; i++) {
-            resbuff[0] = '\0';
+            int start = ovector[i*2];
+            int end   = ovector[i*2+1];
 
-            pcre_copy_substring(str.c_str(), ovector, rc, i, resbuff, str.size());
+            //unset sub pattern
+            if(start < 0) {
+                results->push_back(std::string());
+                continue;
+            }
 
-            results->push_back(std::string(resbuff));
+            results->push_back(str.substr(start, end-start));
         }
-
-        delete[] resbuff;
     }
 
     return true;
@@ -30,6 +30,10 @@
 
 #define REGEX_MAX_MATCHES 100
 
+//upper bound on backtracking for a single match attempt
+#define REGEX_MATCH_LIMIT           50000
+#define REGEX_MATCH_LIMIT_RECURSION 5000
+
 #include "sdlapp.h"
 
 #include "pcre.h"
@@ -51,6 +55,7 @@ class Regex {
     const char *error;
     int erroffset;
     pcre *re;
+    pcre_extra extra;
 
     bool valid;
 
@@ -55,6 +55,23 @@ int stringHash(const std::string& str) {
     return val;
 }
 
+//FNV-1a, used where the hash needs to be well distributed (eg table lookups)
+unsigned int stringHashFNV(const char* str, size_t len) {
+
+    unsigned int hash = 2166136261u;
+
+    for(size_t i=0;i<len;i++) {
+        hash ^= (unsigned char) str[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+unsigned int stringHashFNV(const std::string& str) {
+    return stringHashFNV(str.data(), str.size());
+}
+
 vec2f vec2Hash(const std::string& str) {
     int hash = stringHash(str);
 
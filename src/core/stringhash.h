@@ -36,6 +36,8 @@
 //basic string hash algorithm
 int   intHash(int key);
 int   stringHash(const std::string& str);
+unsigned int stringHashFNV(const char* str, size_t len);
+unsigned int stringHashFNV(const std::string& str);
 vec2f vec2Hash(const std::string& str);
 vec3f vec3Hash(const std::string& str);
 vec3f colourHash(const std::string& str);
@@ -19,15 +19,26 @@ CustomAccessLog::CustomAccessLog() {
 
 bool CustomAccessLog::parseLine(std::string& line, LogEntry& entry) {
 
+    error = LOG_ENTRY_BAD_FORMAT;
+
+    //need the 5 required fields and at most the 6 optional ones
+    int separators = 0;
+
+    for(size_t i=0;i<line.size();i++) {
+        if(line[i] == '|') separators++;
+    }
+
+    if(separators < 4 || separators > 10) return false;
+
     std::vector<std::string> matches;
 
     if(!custom_entry.match(line, &matches)) return false;
 
     entry.timestamp = atol(matches[0].c_str());
-    entry.hostname  = matches[1];
+    entry.setHostname(matches[1]);
     entry.path      = matches[2];
-    entry.response_code = matches[3];
-    entry.response_size = atol(matches[4].c_str());
+    entry.setResponseCode(matches[3]);
+    entry.setResponseSize(matches[4]);
 
     //optional fields
 
@@ -50,8 +61,7 @@ bool CustomAccessLog::parseLine(std::string& line, LogEntry& entry) {
         int r, g, b;
         if(colour.size()>0 &&
            sscanf(colour.c_str(), "%02x%02x%02x", &r, &g, &b) == 3) {
-            entry.response_colour = vec3f( r, g, b );
-            entry.response_colour /= 255.0f;
+            entry.setResponseColour(r, g, b);
         } else {
             entry.setResponseColour();
         }
@@ -77,5 +87,12 @@ bool CustomAccessLog::parseLine(std::string& line, LogEntry& entry) {
         entry.pid = matches[10];
     }
 
-    return entry.validate();
+    if(!entry.validate()) {
+        error = LOG_ENTRY_INVALID;
+        return false;
+    }
+
+    error = LOG_ENTRY_OK;
+
+    return true;
 }
@@ -0,0 +1,384 @@
+/*
+    Copyright (C) 2012 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "groupclassifier.h"
+
+#include <ctype.h>
+#include <string.h>
+#include <deque>
+
+//split a regex into its top level alternatives
+static void groupclassifier_branches(const std::string& regex, std::vector<std::string>& branches) {
+
+    int depth    = 0;
+    size_t start = 0;
+    size_t i     = 0;
+
+    while(i < regex.size()) {
+        char c = regex[i];
+
+        if(c == '\\') {
+            i += 2;
+            continue;
+        }
+
+        if(c == '[') {
+            //skip character class
+            i++;
+            if(i < regex.size() && regex[i] == '^') i++;
+            if(i < regex.size() && regex[i] == ']') i++;
+
+            while(i < regex.size() && regex[i] != ']') {
+                if(regex[i] == '\\') i++;
+                else if(regex[i] == '[' && i+1 < regex.size() && regex[i+1] == ':') {
+                    size_t end = regex.find(":]", i+2);
+                    if(end != std::string::npos) i = end+1;
+                }
+                i++;
+            }
+        } else if(c == '(') {
+            depth++;
+        } else if(c == ')') {
+            depth--;
+        } else if(c == '|' && depth == 0) {
+            branches.push_back(regex.substr(start, i-start));
+            start = i+1;
+        }
+
+        i++;
+    }
+
+    branches.push_back(regex.substr(start));
+}
+
+//end of a {n}, {n,} or {n,m} quantifier starting at i, or npos if
+//the brace is a literal character. min is set to n.
+static size_t groupclassifier_quantifier(const std::string& branch, size_t i, int& min) {
+
+    size_t j = i+1;
+
+    if(j >= branch.size() || !isdigit(branch[j])) return std::string::npos;
+
+    min = 0;
+
+    while(j < branch.size() && isdigit(branch[j])) {
+        min = min * 10 + (branch[j] - '0');
+        j++;
+    }
+
+    if(j < branch.size() && branch[j] == ',') {
+        j++;
+        while(j < branch.size() && isdigit(branch[j])) j++;
+    }
+
+    if(j >= branch.size() || branch[j] != '}') return std::string::npos;
+
+    return j;
+}
+
+//longest run of characters every match of the branch must contain.
+//returns false if the branch uses anything not understood here,
+//in which case it can't be prefiltered.
+static bool groupclassifier_literal(const std::string& branch, std::string& literal) {
+
+    std::string run;
+
+    //true if the last character of the run can still be made optional by a quantifier
+    bool last_literal = false;
+
+    literal.clear();
+
+    size_t i = 0;
+
+    while(i <= branch.size()) {
+
+        bool end_run = true;
+
+        if(i == branch.size()) {
+            i++;
+        } else {
+            char c = branch[i];
+
+            if(c == '\\') {
+                if(i+1 >= branch.size()) return false;
+
+                char e = branch[i+1];
+
+                if(isalnum(e)) {
+                    //escapes taking arguments or changing how the following text is read
+                    if(strchr("xcpPNgkQEou0123456789", e) != 0) return false;
+
+                    //character types and assertions
+                    last_literal = false;
+                } else {
+                    run += e;
+                    last_literal = true;
+                    end_run = false;
+                }
+
+                i += 2;
+
+            } else if(c == '[') {
+
+                i++;
+                if(i < branch.size() && branch[i] == '^') i++;
+                if(i < branch.size() && branch[i] == ']') i++;
+
+                while(i < branch.size() && branch[i] != ']') {
+                    if(branch[i] == '\\') i++;
+                    else if(branch[i] == '[' && i+1 < branch.size() && branch[i+1] == ':') {
+                        size_t end = branch.find(":]", i+2);
+                        if(end != std::string::npos) i = end+1;
+                    }
+                    i++;
+                }
+
+                if(i >= branch.size()) return false;
+
+                i++;
+                last_literal = false;
+
+            } else if(c == '(') {
+
+                //option settings can make the rest of the pattern case insensitive
+                if(i+2 < branch.size() && branch[i+1] == '?' && strchr("imsxXJU-^", branch[i+2]) != 0) return false;
+
+                //skip the group, its contents may be optional
+                int depth = 0;
+
+                while(i < branch.size()) {
+                    if(branch[i] == '\\') {
+                        i++;
+                    } else if(branch[i] == '(') {
+                        depth++;
+                    } else if(branch[i] == ')') {
+                        if(--depth == 0) break;
+                    } else if(branch[i] == '[') {
+                        i++;
+                        if(i < branch.size() && branch[i] == '^') i++;
+                        if(i < branch.size() && branch[i] == ']') i++;
+                        while(i < branch.size() && branch[i] != ']') {
+                            if(branch[i] == '\\') i++;
+                            i++;
+                        }
+                    }
+                    i++;
+                }
+
+                if(i >= branch.size()) return false;
+
+                i++;
+                last_literal = false;
+
+            } else if(c == ')') {
+                return false;
+
+            } else if(c == '*' || c == '?') {
+
+                //preceding character may not appear
+                if(last_literal) run.erase(run.size()-1);
+
+                i++;
+                last_literal = false;
+
+            } else if(c == '{') {
+
+                int min;
+                size_t end = groupclassifier_quantifier(branch, i, min);
+
+                if(end == std::string::npos) {
+                    run += c;
+                    last_literal = true;
+                    end_run = false;
+                    i++;
+                } else {
+                    if(min == 0 && last_literal) run.erase(run.size()-1);
+
+                    i = end+1;
+                    last_literal = false;
+                }
+
+            } else if(c == '+' || c == '.' || c == '^' || c == '$') {
+                i++;
+                last_literal = false;
+
+            } else {
+                run += c;
+                last_literal = true;
+                end_run = false;
+                i++;
+            }
+        }
+
+        if(end_run) {
+            if(run.size() > literal.size()) literal = run;
+            run.clear();
+        }
+    }
+
+    return !literal.empty();
+}
+
+GroupClassifier::GroupClassifier() {
+    generation = 0;
+    built      = false;
+}
+
+GroupClassifier::~GroupClassifier() {
+    for(size_t i=0;i<groups.size();i++) {
+        delete groups[i].regex;
+    }
+}
+
+void GroupClassifier::addGroup(const std::string& regex) {
+
+    Group group;
+    group.regex       = new Regex(regex);
+    group.prefiltered = true;
+    group.seen        = 0;
+
+    int index = groups.size();
+
+    std::vector<std::string> branches;
+    groupclassifier_branches(regex, branches);
+
+    std::vector<std::string> group_literals;
+
+    for(size_t i=0;i<branches.size();i++) {
+        std::string literal;
+
+        if(!groupclassifier_literal(branches[i], literal)) {
+            group.prefiltered = false;
+            break;
+        }
+
+        group_literals.push_back(literal);
+    }
+
+    if(group.prefiltered) {
+        for(size_t i=0;i<group_literals.size();i++) {
+            literals.push_back(group_literals[i]);
+            literal_groups.push_back(index);
+        }
+    }
+
+    groups.push_back(group);
+
+    built = false;
+}
+
+void GroupClassifier::build() {
+
+    delta.clear();
+    outputs.clear();
+
+    delta.resize(256, -1);
+    outputs.resize(1);
+
+    //trie of the literals
+    for(size_t l=0;l<literals.size();l++) {
+        const std::string& literal = literals[l];
+
+        int state = 0;
+
+        for(size_t i=0;i<literal.size();i++) {
+            int& next = delta[state*256 + (unsigned char) literal[i]];
+
+            if(next == -1) {
+                next = outputs.size();
+                outputs.resize(outputs.size()+1);
+                delta.resize(delta.size()+256, -1);
+            }
+
+            state = delta[state*256 + (unsigned char) literal[i]];
+        }
+
+        outputs[state].push_back(literal_groups[l]);
+    }
+
+    //fill in failure transitions breadth first, so every state
+    //has a transition for every byte
+    std::vector<int> fail(outputs.size(), 0);
+    std::deque<int> queue;
+
+    for(int c=0;c<256;c++) {
+        int& next = delta[c];
+
+        if(next == -1) {
+            next = 0;
+        } else {
+            fail[next] = 0;
+            queue.push_back(next);
+        }
+    }
+
+    while(!queue.empty()) {
+        int state = queue.front();
+        queue.pop_front();
+
+        for(int c=0;c<256;c++) {
+            int& next = delta[state*256 + c];
+
+            if(next == -1) {
+                next = delta[fail[state]*256 + c];
+            } else {
+                fail[next] = delta[fail[state]*256 + c];
+
+                const std::vector<int>& inherited = outputs[fail[next]];
+                outputs[next].insert(outputs[next].end(), inherited.begin(), inherited.end());
+
+                queue.push_back(next);
+            }
+        }
+    }
+
+    built = true;
+}
+
+int GroupClassifier::classify(const std::string& str) {
+
+    if(!built) build();
+
+    if(++generation == 0) {
+        for(size_t i=0;i<groups.size();i++) groups[i].seen = 0;
+        generation = 1;
+    }
+
+    //mark groups with a literal present
+    int state = 0;
+
+    for(size_t i=0;i<str.size();i++) {
+        state = delta[state*256 + (unsigned char) str[i]];
+
+        const std::vector<int>& found = outputs[state];
+
+        for(size_t j=0;j<found.size();j++) {
+            groups[found[j]].seen = generation;
+        }
+    }
+
+    //confirm candidates in order
+    for(size_t i=0;i<groups.size();i++) {
+        Group& group = groups[i];
+
+        if(group.prefiltered && group.seen != generation) continue;
+
+        if(group.regex->match(str)) return i;
+    }
+
+    return -1;
+}
@@ -0,0 +1,66 @@
+/*
+    Copyright (C) 2012 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GROUP_CLASSIFIER_H
+#define GROUP_CLASSIFIER_H
+
+#include <string>
+#include <vector>
+
+#include "core/regex.h"
+
+//finds the first of a list of url group regexes matching a string.
+//
+//a literal that any match of the regex must contain is taken from each
+//branch of each group's regex, and all of them are searched for in one
+//pass with an Aho-Corasick automaton. only groups with a literal found
+//(or with no usable literal at all) are then confirmed with their regex,
+//in group order.
+
+class GroupClassifier {
+
+    struct Group {
+        Regex* regex;
+        bool   prefiltered;
+        unsigned int seen;
+    };
+
+    std::vector<Group> groups;
+
+    std::vector<std::string> literals;
+    std::vector<int>         literal_groups;
+
+    //dense transition table, 256 entries per state
+    std::vector<int> delta;
+    std::vector< std::vector<int> > outputs;
+
+    unsigned int generation;
+    bool built;
+
+    void build();
+public:
+    GroupClassifier();
+    ~GroupClassifier();
+
+    void addGroup(const std::string& regex);
+
+    int classify(const std::string& str);
+
+    size_t size() const { return groups.size(); }
+};
+
+#endif
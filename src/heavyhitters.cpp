@@ -0,0 +1,189 @@
+/*
+    Copyright (C) 2012 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "heavyhitters.h"
+
+#include <algorithm>
+
+HeavyHitters::HeavyHitters(size_t capacity) {
+    this->capacity = capacity;
+
+    total       = 0;
+    max_evicted = 0;
+
+    heap.reserve(capacity);
+
+    //rows of 8 counters per tracked string, a power of two to mask hashes
+    size_t width = 1024;
+    while(width < capacity * 8) width *= 2;
+
+    sketch_mask = width - 1;
+    sketch.resize(width * HEAVY_HITTERS_DEPTH, 0);
+}
+
+//each row uses a different combination of two halves of the hash
+unsigned int HeavyHitters::updateSketch(const std::string& key) {
+
+    unsigned int h1 = stringHashFNV(key);
+    unsigned int h2 = ((h1 >> 16) | (h1 << 16)) * 0x45d9f3b | 1;
+
+    unsigned int width = sketch_mask + 1;
+    unsigned int lowest = 0xffffffff;
+
+    for(unsigned int row=0;row<HEAVY_HITTERS_DEPTH;row++) {
+        unsigned int& cell = sketch[row * width + ((h1 + row * h2) & sketch_mask)];
+
+        if(cell < 0xffffffff) cell++;
+        if(cell < lowest) lowest = cell;
+    }
+
+    return lowest;
+}
+
+unsigned int HeavyHitters::estimate(const std::string& key) const {
+
+    unsigned int h1 = stringHashFNV(key);
+    unsigned int h2 = ((h1 >> 16) | (h1 << 16)) * 0x45d9f3b | 1;
+
+    unsigned int width = sketch_mask + 1;
+    unsigned int lowest = 0xffffffff;
+
+    for(unsigned int row=0;row<HEAVY_HITTERS_DEPTH;row++) {
+        unsigned int cell = sketch[row * width + ((h1 + row * h2) & sketch_mask)];
+
+        if(cell < lowest) lowest = cell;
+    }
+
+    return lowest;
+}
+
+void HeavyHitters::swapCounters(size_t a, size_t b) {
+    std::swap(heap[a].key,   heap[b].key);
+    std::swap(heap[a].count, heap[b].count);
+    std::swap(heap[a].error, heap[b].error);
+
+    positions[heap[a].key.getId()] = a;
+    positions[heap[b].key.getId()] = b;
+}
+
+//counts only ever increase, so a counter can only need to move down
+void HeavyHitters::siftDown(size_t i) {
+
+    size_t no_counters = heap.size();
+
+    for(;;) {
+        size_t smallest = i;
+        size_t left     = i*2 + 1;
+        size_t right    = left + 1;
+
+        if(left  < no_counters && heap[left].count  < heap[smallest].count) smallest = left;
+        if(right < no_counters && heap[right].count < heap[smallest].count) smallest = right;
+
+        if(smallest == i) break;
+
+        swapCounters(i, smallest);
+        i = smallest;
+    }
+}
+
+bool HeavyHitters::add(const InternedString& key, InternedString& evicted, unsigned int& evicted_seen) {
+
+    total++;
+
+    unsigned int sketch_count = updateSketch(key);
+
+    std::map<unsigned int, size_t>::iterator it = positions.find(key.getId());
+
+    if(it != positions.end()) {
+        size_t i = it->second;
+
+        heap[i].count++;
+        siftDown(i);
+
+        return false;
+    }
+
+    //still room, so counted exactly from the start
+    if(heap.size() < capacity) {
+        Counter counter;
+        counter.key   = key;
+        counter.count = 1;
+        counter.error = 0;
+
+        size_t i = heap.size();
+
+        heap.push_back(counter);
+        positions[key.getId()] = i;
+
+        //move up past any counters that are higher
+        while(i > 0 && heap[(i-1)/2].count > heap[i].count) {
+            swapCounters(i, (i-1)/2);
+            i = (i-1)/2;
+        }
+
+        return false;
+    }
+
+    //replace the string with the lowest count
+    Counter& lowest = heap[0];
+
+    evicted      = lowest.key;
+    evicted_seen = lowest.count - lowest.error;
+
+    if(lowest.count > max_evicted) max_evicted = lowest.count;
+
+    positions.erase(lowest.key.getId());
+
+    //the string was seen at most max_evicted times while not tracked, and
+    //the sketch never undercounts, so either bounds its count
+    unsigned int count = max_evicted + 1;
+    if(sketch_count < count) count = sketch_count;
+
+    lowest.key   = key;
+    lowest.count = count;
+    lowest.error = count - 1;
+
+    positions[key.getId()] = 0;
+
+    siftDown(0);
+
+    return true;
+}
+
+bool HeavyHitters::isTracked(const InternedString& key) const {
+    return positions.find(key.getId()) != positions.end();
+}
+
+void HeavyHitters::getTracked(std::vector<InternedString>& keys, std::vector<unsigned int>& seen) const {
+
+    size_t no_counters = heap.size();
+
+    for(size_t i=0;i<no_counters;i++) {
+        keys.push_back(heap[i].key);
+        seen.push_back(heap[i].count - heap[i].error);
+    }
+}
+
+void HeavyHitters::clear() {
+    heap.clear();
+    positions.clear();
+
+    std::fill(sketch.begin(), sketch.end(), 0);
+
+    total       = 0;
+    max_evicted = 0;
+}
@@ -0,0 +1,95 @@
+/*
+    Copyright (C) 2012 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HEAVY_HITTERS_H
+#define HEAVY_HITTERS_H
+
+#include <vector>
+#include <map>
+
+#include "stringtable.h"
+
+//rows of the count-min sketch
+#define HEAVY_HITTERS_DEPTH 4
+
+//approximate request counts of the busiest strings in a fixed amount of memory.
+//
+//the top 'capacity' strings are tracked with the Space-Saving algorithm: a new
+//string replaces the one with the lowest count, and starts from the highest
+//count any replaced string had, as its error. a count-min sketch of every
+//string seen gives a second upper bound that tightens the starting count.
+//
+//the count of a tracked string is never less than its true count and at most
+//'error' more. any string not tracked has been seen at most getMaxUntracked()
+//times. as the sketch can start a counter below the one it replaces, this may
+//be more than the lowest count.
+
+class HeavyHitters {
+
+    struct Counter {
+        InternedString key;
+        unsigned int count;
+        unsigned int error;
+    };
+
+    //min-heap on count
+    std::vector<Counter> heap;
+
+    //heap position of each tracked string by id
+    std::map<unsigned int, size_t> positions;
+
+    size_t capacity;
+
+    std::vector<unsigned int> sketch;
+    unsigned int sketch_mask;
+
+    unsigned long total;
+
+    //highest count of a replaced string
+    unsigned int max_evicted;
+
+    void siftDown(size_t i);
+    void swapCounters(size_t a, size_t b);
+
+    unsigned int updateSketch(const std::string& key);
+public:
+    HeavyHitters(size_t capacity);
+
+    //count a request for key. returns true if key replaced another string,
+    //which is returned along with the number of times it was counted while
+    //it was tracked
+    bool add(const InternedString& key, InternedString& evicted, unsigned int& evicted_seen);
+
+    bool isTracked(const InternedString& key) const;
+
+    //tracked strings and the number of times each was counted while tracked
+    void getTracked(std::vector<InternedString>& keys, std::vector<unsigned int>& seen) const;
+
+    void clear();
+
+    //count-min estimate of how often any string has been seen
+    unsigned int estimate(const std::string& key) const;
+
+    //most times a string not tracked can have been seen
+    unsigned int getMaxUntracked() const { return max_evicted; }
+
+    size_t size() const          { return heap.size(); }
+    size_t getCapacity() const   { return capacity; }
+    unsigned long getTotal() const { return total; }
+};
+
+#endif
@@ -0,0 +1,353 @@
+/*
+    Copyright (C) 2012 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "hostaddress.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static int hostaddress_hex_value(char c) {
+    if(c >= '0' && c <= '9') return c - '0';
+    if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+HostAddress::HostAddress() {
+    type = HOST_ADDRESS_NONE;
+    memset(bytes, 0, sizeof(bytes));
+}
+
+int HostAddress::bits() const {
+    if(type == HOST_ADDRESS_IPV4) return 32;
+    if(type == HOST_ADDRESS_IPV6) return 128;
+    return 0;
+}
+
+//dotted quad, 1-3 digits per octet (ie 192.168.0.1)
+bool HostAddress::parseIPv4(const char* str, size_t len, unsigned char* out) {
+
+    int octets = 0;
+    size_t i   = 0;
+
+    while(i < len) {
+        if(octets == 4) return false;
+
+        int value  = 0;
+        int digits = 0;
+
+        while(i < len && str[i] >= '0' && str[i] <= '9') {
+            value = value * 10 + (str[i] - '0');
+            if(++digits > 3) return false;
+            i++;
+        }
+
+        if(digits == 0 || value > 255) return false;
+
+        out[octets++] = (unsigned char) value;
+
+        if(i == len) break;
+
+        if(str[i] != '.' || i+1 == len) return false;
+        i++;
+    }
+
+    return octets == 4;
+}
+
+//colon separated hex groups with optional '::' and trailing dotted quad
+//(ie 2001:db8::1, ::ffff:192.168.0.1)
+bool HostAddress::parseIPv6(const char* str, size_t len) {
+
+    unsigned short groups[8];
+    int no_groups = 0;
+    int gap       = -1;
+
+    size_t i = 0;
+
+    if(len >= 2 && str[0] == ':' && str[1] == ':') {
+        gap = 0;
+        i   = 2;
+    } else if(len == 0 || str[0] == ':') {
+        return false;
+    }
+
+    while(i < len) {
+        if(no_groups == 8) return false;
+
+        size_t j = i;
+        int value  = 0;
+        int digits = 0;
+        int hex;
+
+        while(j < len && (hex = hostaddress_hex_value(str[j])) != -1) {
+            value = (value << 4) | hex;
+            if(++digits > 4) break;
+            j++;
+        }
+
+        //embedded IPv4 address as the last 32 bits
+        if((j < len && str[j] == '.') || digits > 4) {
+            unsigned char ipv4[4];
+
+            if(no_groups > 6 || !parseIPv4(str+i, len-i, ipv4)) return false;
+
+            groups[no_groups++] = (ipv4[0] << 8) | ipv4[1];
+            groups[no_groups++] = (ipv4[2] << 8) | ipv4[3];
+            i = len;
+            break;
+        }
+
+        if(digits == 0) return false;
+
+        groups[no_groups++] = (unsigned short) value;
+
+        if(j == len) {
+            i = j;
+            break;
+        }
+
+        if(str[j] != ':' || ++j == len) return false;
+
+        if(str[j] == ':') {
+            if(gap != -1) return false;
+            gap = no_groups;
+            j++;
+        }
+
+        i = j;
+    }
+
+    if(gap == -1 && no_groups != 8) return false;
+    if(gap != -1 && no_groups > 7)  return false;
+
+    memset(bytes, 0, sizeof(bytes));
+
+    int head = (gap == -1) ? no_groups : gap;
+
+    for(int g=0;g<head;g++) {
+        bytes[g*2]   = groups[g] >> 8;
+        bytes[g*2+1] = groups[g] & 0xff;
+    }
+
+    int tail = no_groups - head;
+
+    for(int g=0;g<tail;g++) {
+        int dest = 8 - tail + g;
+        bytes[dest*2]   = groups[head+g] >> 8;
+        bytes[dest*2+1] = groups[head+g] & 0xff;
+    }
+
+    return true;
+}
+
+bool HostAddress::parse(const std::string& str) {
+
+    const char* s = str.c_str();
+    size_t len    = str.size();
+
+    type = HOST_ADDRESS_NONE;
+
+    if(len == 0) return false;
+
+    //quick reject for hostnames - addresses only contain hex digits, '.' and ':'
+    bool colon = false;
+    size_t end = len;
+
+    for(size_t i=0;i<len;i++) {
+        char c = s[i];
+
+        if(c == ':') colon = true;
+        else if(c == '%' || c == ']') { end = i; break; }
+        else if(c != '.' && c != '[' && hostaddress_hex_value(c) == -1) return false;
+    }
+
+    if(!colon) {
+        //zone ids and brackets are only used with IPv6 addresses
+        if(end != len || !parseIPv4(s, len, bytes)) return false;
+
+        memset(bytes+4, 0, 12);
+        type = HOST_ADDRESS_IPV4;
+        return true;
+    }
+
+    //drop any zone id (fe80::1%eth0) or closing bracket
+    len = end;
+
+    if(s[0] == '[') {
+        s++;
+        len--;
+    }
+
+    if(!parseIPv6(s, len)) return false;
+
+    type = HOST_ADDRESS_IPV6;
+
+    //treat IPv4-mapped addresses (::ffff:a.b.c.d) as IPv4
+    static const unsigned char mapped_prefix[12] = { 0,0,0,0,0,0,0,0,0,0,0xff,0xff };
+
+    if(memcmp(bytes, mapped_prefix, 12) == 0) {
+        memmove(bytes, bytes+12, 4);
+        memset(bytes+4, 0, 12);
+        type = HOST_ADDRESS_IPV4;
+    }
+
+    return true;
+}
+
+bool HostAddress::parsePrefix(const std::string& str, int& prefix_bits) {
+
+    if(str.empty() || str[str.size()-1] != '-') {
+        if(!parse(str)) return false;
+
+        prefix_bits = bits();
+        return true;
+    }
+
+    std::string prefix = str.substr(0, str.size()-1);
+
+    //pad the shown octets or groups out to a full address
+    bool ipv6 = prefix.find(':') != std::string::npos;
+
+    //a single IPv6 group is written with a trailing ':' (ie 2001:-)
+    if(ipv6 && prefix[prefix.size()-1] == ':') {
+        prefix.resize(prefix.size()-1);
+    }
+
+    if(!ipv6) {
+        int octets = 1;
+
+        for(size_t i=0;i<prefix.size();i++) {
+            if(prefix[i] == '.') octets++;
+        }
+
+        if(octets >= 4) return false;
+
+        for(int i=octets;i<4;i++) prefix += ".0";
+
+        if(!parse(prefix) || type != HOST_ADDRESS_IPV4) return false;
+
+        prefix_bits = octets * 8;
+        return true;
+    }
+
+    int groups = 1;
+
+    for(size_t i=0;i<prefix.size();i++) {
+        if(prefix[i] == ':') groups++;
+    }
+
+    if(groups >= 8 || prefix.find("::") != std::string::npos) return false;
+
+    prefix += "::";
+
+    if(!parse(prefix) || type != HOST_ADDRESS_IPV6) return false;
+
+    prefix_bits = groups * 16;
+    return true;
+}
+
+void HostAddress::mask(int prefix_bits) {
+    int total = bits();
+
+    if(prefix_bits < 0) prefix_bits = 0;
+
+    for(int i=prefix_bits;i<total;i++) {
+        bytes[i/8] &= ~(0x80 >> (i%8));
+    }
+}
+
+//masked address truncated to the prefix, with a trailing '-' if anything was hidden
+//(ie 192.168.0.1/24 => 192.168.0-, 2001:db8:1234:5::1/48 => 2001:db8:1234-,
+// 2001:db8::1/16 => 2001:-)
+std::string HostAddress::prefixString(int prefix_bits) const {
+
+    int total = bits();
+
+    if(prefix_bits > total) prefix_bits = total;
+    if(prefix_bits < 0)     prefix_bits = 0;
+
+    HostAddress masked = *this;
+    masked.mask(prefix_bits);
+
+    char buff[64];
+    int  pos = 0;
+
+    if(type == HOST_ADDRESS_IPV4) {
+        int octets = (prefix_bits + 7) / 8;
+
+        for(int i=0;i<octets;i++) {
+            pos += snprintf(buff+pos, sizeof(buff)-pos, i>0 ? ".%d" : "%d", masked.bytes[i]);
+        }
+
+    } else if(type == HOST_ADDRESS_IPV6) {
+        int no_groups = (prefix_bits + 15) / 16;
+
+        for(int i=0;i<no_groups;i++) {
+            int group = (masked.bytes[i*2] << 8) | masked.bytes[i*2+1];
+            pos += snprintf(buff+pos, sizeof(buff)-pos, i>0 ? ":%x" : "%x", group);
+        }
+
+        //so a single group can't be read back as an IPv4 octet
+        if(no_groups == 1 && prefix_bits < total) buff[pos++] = ':';
+    }
+
+    std::string output(buff, pos);
+
+    if(prefix_bits < total) output += '-';
+
+    return output;
+}
+
+//masked address in CIDR notation, or just the address if nothing is hidden
+//(ie 10.1.0.0/16, 2001:db8::/32)
+std::string HostAddress::cidrString(int prefix_bits) const {
+
+    int total = bits();
+
+    if(prefix_bits > total) prefix_bits = total;
+    if(prefix_bits < 0)     prefix_bits = 0;
+
+    HostAddress masked = *this;
+    masked.mask(prefix_bits);
+
+    char buff[64];
+    int  pos = 0;
+
+    if(type == HOST_ADDRESS_IPV4) {
+        pos = snprintf(buff, sizeof(buff), "%d.%d.%d.%d", masked.bytes[0], masked.bytes[1], masked.bytes[2], masked.bytes[3]);
+
+    } else if(type == HOST_ADDRESS_IPV6) {
+        int no_groups = (prefix_bits < total) ? (prefix_bits + 15) / 16 : 8;
+
+        for(int i=0;i<no_groups;i++) {
+            int group = (masked.bytes[i*2] << 8) | masked.bytes[i*2+1];
+            pos += snprintf(buff+pos, sizeof(buff)-pos, i>0 ? ":%x" : "%x", group);
+        }
+
+        if(no_groups < 8) pos += snprintf(buff+pos, sizeof(buff)-pos, "::");
+    }
+
+    std::string output(buff, pos);
+
+    if(prefix_bits < total) {
+        snprintf(buff, sizeof(buff), "/%d", prefix_bits);
+        output += buff;
+    }
+
+    return output;
+}
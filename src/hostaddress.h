@@ -0,0 +1,52 @@
+/*
+    Copyright (C) 2012 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOST_ADDRESS_H
+#define HOST_ADDRESS_H
+
+#include <string>
+
+enum { HOST_ADDRESS_NONE,
+       HOST_ADDRESS_IPV4,
+       HOST_ADDRESS_IPV6 };
+
+//numeric IPv4/IPv6 address parsed directly from the bytes of a hostname
+//(IPv4 addresses are stored in the first 4 bytes)
+
+class HostAddress {
+
+    bool parseIPv4(const char* str, size_t len, unsigned char* out);
+    bool parseIPv6(const char* str, size_t len);
+public:
+    int type;
+    unsigned char bytes[16];
+
+    HostAddress();
+
+    bool parse(const std::string& str);
+
+    //address or output of prefixString, giving the number of bits it shows
+    bool parsePrefix(const std::string& str, int& prefix_bits);
+
+    int bits() const;
+
+    void mask(int prefix_bits);
+    std::string prefixString(int prefix_bits) const;
+    std::string cidrString(int prefix_bits) const;
+};
+
+#endif
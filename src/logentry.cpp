@@ -18,96 +18,291 @@
 #include "logentry.h"
 
 bool  gMask    = true;
+int   gMaskIPv4Bits = 24;
+int   gMaskIPv6Bits = 48;
 
 
 //AccessLog
 
 AccessLog::AccessLog() {
+    error = LOG_ENTRY_OK;
+}
+
+//LogEntryTextBlock
+
+#define LOGENTRY_TEXT_BLOCK_SIZE 65536
+
+LogEntryTextBlock* logentry_text_block = 0;
+
+LogEntryTextBlock::LogEntryTextBlock(size_t size) {
+    this->refs = 0;
+    this->size = size;
+    this->used = 0;
+    this->data = new char[size];
+}
+
+LogEntryTextBlock::~LogEntryTextBlock() {
+    delete[] data;
+}
+
+//LogEntryText
+
+LogEntryText::LogEntryText() {
+    block  = 0;
+    offset = 0;
+    length = 0;
+}
+
+LogEntryText::LogEntryText(const LogEntryText& other) {
+    block  = other.block;
+    offset = other.offset;
+    length = other.length;
+
+    if(block != 0) block->refs++;
+}
+
+LogEntryText::~LogEntryText() {
+    release();
+}
+
+void LogEntryText::release() {
+    if(block != 0 && --block->refs == 0) {
+        delete block;
+    }
+    block = 0;
+}
+
+void LogEntryText::clear() {
+    release();
+    offset = 0;
+    length = 0;
+}
+
+LogEntryText& LogEntryText::operator=(const LogEntryText& other) {
+    if(other.block != 0) other.block->refs++;
+
+    release();
+
+    block  = other.block;
+    offset = other.offset;
+    length = other.length;
+
+    return *this;
+}
+
+LogEntryText& LogEntryText::operator=(const std::string& str) {
+    clear();
+
+    if(str.empty()) return *this;
+
+    //start a new block if the current one is full, the current block
+    //is freed once the last entry referencing it is gone
+    if(logentry_text_block == 0 || logentry_text_block->size - logentry_text_block->used < str.size()) {
+
+        if(logentry_text_block != 0 && --logentry_text_block->refs == 0) {
+            delete logentry_text_block;
+        }
+
+        logentry_text_block = new LogEntryTextBlock(std::max((size_t)LOGENTRY_TEXT_BLOCK_SIZE, str.size()));
+        logentry_text_block->refs++;
+    }
+
+    block  = logentry_text_block;
+    offset = block->used;
+    length = str.size();
+
+    memcpy(block->data + offset, str.data(), length);
+
+    block->used += length;
+    block->refs++;
+
+    return *this;
+}
+
+std::string LogEntryText::str() const {
+    if(block == 0) return std::string();
+
+    return std::string(block->data + offset, length);
 }
 
 //LogEntry
 
+//response colour palette, the response code classes followed by any custom colours
+enum { LOG_ENTRY_COLOUR_INFO,
+       LOG_ENTRY_COLOUR_SUCCESS,
+       LOG_ENTRY_COLOUR_REDIRECT,
+       LOG_ENTRY_COLOUR_ERROR,
+       LOG_ENTRY_STATUS_COLOURS };
+
+#define LOGENTRY_MAX_COLOURS 65536
+
+vec3f logentry_status_colours[LOG_ENTRY_STATUS_COLOURS] = {
+    vec3f(0.0f, 1.0f, 0.5f),
+    vec3f(1.0f, 1.0f, 0.0f),
+    vec3f(1.0f, 0.5f, 0.0f),
+    vec3f(1.0f, 0.0f, 0.0f)
+};
+
+std::vector<vec3f> logentry_custom_colours;
+std::map<int, unsigned short> logentry_custom_colour_index;
+
 LogEntry::LogEntry() {
     timestamp = 0;
     response_size = 0;
+    status = 0;
+    group  = -1;
     successful = false;
-    response_colour = vec3f(1.0, 0.0, 0.0);
+    colour_index = LOG_ENTRY_COLOUR_ERROR;
 }
 
-Regex logentry_hostname_parts("([^.]+)(?:\\.([^.]+))?(?:\\.([^.]+))?(?:\\.([^.]+))?(?:\\.([^.]+))?(?:\\.([^.]+))?(?:\\.([^.]+))?(?:\\.([^.]+))?$");
+//direct mapped cache of masked hostnames, as most requests come from repeat clients
+#define LOGENTRY_MASK_CACHE_SIZE 4096
+
+struct MaskedHostname {
+    std::string hostname;
+    std::string masked;
+};
 
-std::string LogEntry::maskHostname(std::string hostname) {
+MaskedHostname logentry_mask_cache[LOGENTRY_MASK_CACHE_SIZE];
 
-    std::vector<std::string> parts;
-    logentry_hostname_parts.match(hostname, &parts);
+std::string LogEntry::maskHostname(const std::string& hostname) {
 
-    //if only 1-2 parts, or 3 parts and a 2 character suffix, pass through unchanged
-    if(parts.size()<=2 || parts.size()==3 && parts[parts.size()-1].size()==2)
-        return hostname;
+    MaskedHostname& cached = logentry_mask_cache[stringHashFNV(hostname) & (LOGENTRY_MASK_CACHE_SIZE-1)];
 
-    int num = atoi(parts[parts.size()-1].c_str());
+    if(cached.hostname.size() && cached.hostname == hostname) {
+        return cached.masked;
+    }
 
     std::string output;
 
-    //if last element is numeric, assume it is a numbered ip address
-    //(ie 192.168.0.1 => 192.168.0-)
-    if(num!=0) {
-        for(size_t i=0;i<parts.size()-1;i++) {
-            if(i>0) output += '.';
-            output += parts[i];
+    HostAddress address;
+
+    if(address.parse(hostname)) {
+
+        //hide the host part of ip addresses
+        //(ie 192.168.0.1 => 192.168.0-, 2001:db8:1234:5::1 => 2001:db8:1234-)
+        output = address.prefixString(address.type == HOST_ADDRESS_IPV4 ? gMaskIPv4Bits : gMaskIPv6Bits);
+
+    } else {
+
+        size_t first_dot = hostname.find('.');
+        size_t last_dot  = hostname.rfind('.');
+
+        int no_parts = 1;
+
+        for(size_t i=first_dot; i != std::string::npos; i = hostname.find('.', i+1)) {
+            no_parts++;
         }
 
-        output += '-';
-        return output;
+        //if only 1-2 parts, or 3 parts and a 2 character suffix, pass through unchanged
+        if(no_parts<=2 || no_parts==3 && hostname.size()-last_dot-1 == 2) {
+            output = hostname;
+        } else {
+            //hide the first element
+            //(ie dhcp113.web.com -> web.com
+            output = hostname.substr(first_dot+1);
+        }
     }
 
-    //hide the first element
-    //(ie dhcp113.web.com -> web.com
-    for(size_t i=1;i<parts.size();i++) {
-            if(i>1) output += '.';
-            output += parts[i];
-    }
+    cached.hostname = hostname;
+    cached.masked   = output;
 
     return output;
 }
 
-void LogEntry::setSuccess() {
+//mask before interning so only the masked form goes into the string table
+void LogEntry::setHostname(const std::string& hostname) {
+    if(gMask) {
+        this->hostname = maskHostname(hostname);
+    } else {
+        this->hostname = hostname;
+    }
+}
+
+//keeps the code as text for display and parses the status once
+void LogEntry::setResponseCode(const std::string& response_code) {
 
-    int code = atoi(response_code.c_str());
+    //truncate to what can sensibly be drawn on a ball
+    if(response_code.size() > 15) {
+        this->response_code = response_code.substr(0, 15);
+    } else {
+        this->response_code = response_code;
+    }
+
+    long code = atol(response_code.c_str());
+
+    if(code < 0)     code = 0;
+    if(code > 32767) code = 32767;
 
-    successful = (code<400) ? true : false;
+    status = (short) code;
 }
 
-void LogEntry::setResponseColour() {
+void LogEntry::setResponseSize(const std::string& response_size) {
+
+    unsigned long bytes = strtoul(response_size.c_str(), 0, 10);
 
-    int code = atoi(response_code.c_str());
+    if(bytes > 0xffffffff) bytes = 0xffffffff;
+
+    this->response_size = bytes;
+}
+
+void LogEntry::setSuccess() {
+    successful = (status<400) ? true : false;
+}
+
+void LogEntry::setResponseColour() {
 
     //set response colour
-    if(code<200) {
-        response_colour = vec3f(0.0f, 1.0f, 0.5f);
+    if(status<200) {
+        colour_index = LOG_ENTRY_COLOUR_INFO;
     }
-    else if(code>= 200 && code < 300) {
-        response_colour = vec3f(1.0f, 1.0f, 0.0f);
+    else if(status>= 200 && status < 300) {
+        colour_index = LOG_ENTRY_COLOUR_SUCCESS;
     }
-    else if(code>= 300 && code < 400) {
-        response_colour = vec3f(1.0f, 0.5f, 0.0f);
+    else if(status>= 300 && status < 400) {
+        colour_index = LOG_ENTRY_COLOUR_REDIRECT;
     }
     else {
-        response_colour = vec3f(1.0f, 0.0f, 0.0f);
+        colour_index = LOG_ENTRY_COLOUR_ERROR;
     }
 }
 
-bool LogEntry::validate() {
-    if(pid == "-") pid = "";
-    if(referrer == "-") referrer = "";
+void LogEntry::setResponseColour(int r, int g, int b) {
 
-    if(hostname.size()==0) return false;
+    int rgb = (r << 16) | (g << 8) | b;
 
-    if(gMask) {
-        hostname = maskHostname(hostname);
+    std::map<int, unsigned short>::iterator it = logentry_custom_colour_index.find(rgb);
+
+    if(it != logentry_custom_colour_index.end()) {
+        colour_index = it->second;
+        return;
     }
 
-    if(path.size()==0) return false;
+    //fall back to the status colour once the palette is full
+    if(logentry_custom_colours.size() + LOG_ENTRY_STATUS_COLOURS >= LOGENTRY_MAX_COLOURS) {
+        setResponseColour();
+        return;
+    }
+
+    colour_index = LOG_ENTRY_STATUS_COLOURS + logentry_custom_colours.size();
+
+    logentry_custom_colours.push_back(vec3f(r, g, b) / 255.0f);
+    logentry_custom_colour_index[rgb] = colour_index;
+}
+
+const vec3f& LogEntry::getResponseColour() const {
+    if(colour_index < LOG_ENTRY_STATUS_COLOURS) return logentry_status_colours[colour_index];
+
+    return logentry_custom_colours[colour_index - LOG_ENTRY_STATUS_COLOURS];
+}
+
+bool LogEntry::validate() {
+    if(pid.str() == "-") pid = InternedString();
+    if(referrer.size()==1 && referrer.data()[0] == '-') referrer.clear();
+
+    if(hostname.empty()) return false;
+
+    if(path.empty()) return false;
     if(timestamp == 0) return false;
 
     return true;
@@ -22,48 +22,130 @@
 #include <string.h>
 
 #include <vector>
+#include <map>
 #include <time.h>
 
 #include "core/sdlapp.h"
 #include "core/vectors.h"
 #include "core/regex.h"
+#include "core/stringhash.h"
+
+#include "hostaddress.h"
+#include "stringtable.h"
+#include "slabpool.h"
+
+//reasons a line was not turned into an entry
+enum { LOG_ENTRY_OK,
+       LOG_ENTRY_BAD_FORMAT,
+       LOG_ENTRY_BAD_DATE,
+       LOG_ENTRY_BAD_REQUEST,
+       LOG_ENTRY_INVALID,
+       LOG_ENTRY_TOO_LONG,
+       LOG_ENTRY_FILTERED,
+       LOG_ENTRY_ERROR_TYPES };
 
 extern bool  gMask;
+extern int   gMaskIPv4Bits;
+extern int   gMaskIPv6Bits;
+
+//block of text shared by the entries parsed while it was current
+
+class LogEntryTextBlock {
+public:
+    int    refs;
+    size_t size;
+    size_t used;
+    char*  data;
+
+    LogEntryTextBlock(size_t size);
+    ~LogEntryTextBlock();
+};
+
+//rarely read field of an entry stored as an offset into a text block,
+//only copied into a string when it is actually displayed
+
+class LogEntryText {
+    LogEntryTextBlock* block;
+    unsigned int offset;
+    unsigned int length;
+
+    void release();
+public:
+    LogEntryText();
+    LogEntryText(const LogEntryText& other);
+    ~LogEntryText();
+
+    LogEntryText& operator=(const LogEntryText& other);
+    LogEntryText& operator=(const std::string& str);
+
+    void clear();
+
+    size_t size() const { return length; }
+    const char* data() const { return block != 0 ? block->data + offset : ""; }
+
+    std::string str() const;
+};
 
 class LogEntry {
 
 private:
-    std::string maskHostname(std::string hostname);
+    std::string maskHostname(const std::string& hostname);
 public:
     LogEntry();
     bool validate();
 
+    static void* operator new(size_t size)           { return slaballocator.allocate(size); }
+    static void  operator delete(void* ptr, size_t size) { slaballocator.release(ptr, size); }
+
+    void setHostname(const std::string& hostname);
+    void setResponseCode(const std::string& response_code);
+    void setResponseSize(const std::string& response_size);
+
     void setSuccess();
     void setResponseColour();
+    void setResponseColour(int r, int g, int b);
+
+    const vec3f& getResponseColour() const;
+
+    //fields used while the entry is queued or in flight,
+    //kept together and under 64 bytes
 
     time_t timestamp;
 
-    std::string hostname;
-    std::string vhost;
+    InternedString hostname;
+    InternedString vhost;
 
-    std::string path;
+    InternedString path;
 
-    std::string pid;
+    InternedString pid;
 
-    std::string response_code;
-    long response_size;
+    InternedString response_code;
 
-    std::string referrer;
-    std::string user_agent;
+    //path as displayed in the url summarizer
+    InternedString display_path;
 
-    vec3f response_colour;
+    unsigned int   response_size;
+    short          status;
 
-    bool successful;
+    //index of the url group the path belongs to
+    short          group;
+
+    //index into the response colour palette
+    unsigned short colour_index;
+
+    bool successful : 1;
+
+    //only read when displaying the entry
+
+    LogEntryText referrer;
+    LogEntryText user_agent;
 };
 
 class AccessLog {
 
 public:
+    int error;
+
     AccessLog();
     virtual ~AccessLog() {};
     virtual bool parseLine(std::string& line, LogEntry& entry) {};
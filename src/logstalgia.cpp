@@ -31,6 +31,14 @@ int   gFontSize = 14;
 bool  gDisableProgress = false;
 bool  gSyncLog         = false;
 bool  gHideURLPrefix   = false;
+int   gHeavyHitters    = 0;
+bool  gCIDRSummary     = false;
+int   gMergeRate       = 0;
+
+bool  gAdaptiveSpeed     = false;
+float gAdaptiveMinSpeed  = 1.0f;
+float gAdaptiveMaxSpeed  = 30.0f;
+int   gAdaptiveSpawnRate = 500;
 
 std::string profile_name;
 Uint32 profile_start_msec;
@@ -77,8 +85,14 @@ void logstalgia_help() {
     printf("  -b --background FFFFFF     Background colour in hex\n\n");
 
     printf("  -x --full-hostnames        Show full request ip/hostname\n");
+    printf("  --ipv4-mask BITS           Prefix of IPv4 addresses to show (default: 24)\n");
+    printf("  --ipv6-mask BITS           Prefix of IPv6 addresses to show (default: 48)\n");
     printf("  -s --speed                 Simulation speed (default: 1)\n");
-    printf("  -u --update-rate           Page summary update rate (default: 5)\n\n");
+    printf("  -u --update-rate           Page summary update rate (default: 5)\n");
+    printf("  --merge-rate RATE          Merge similar requests when more than RATE per second\n");
+    printf("  --adaptive-speed MIN,MAX[,RATE]  Vary speed to spawn about RATE balls per second\n");
+    printf("  --heavy-hitters COUNT      Only summarize the COUNT busiest hosts\n");
+    printf("  --cidr-summary             Summarize addresses by CIDR block\n\n");
     printf("  -g name,regex,percent[,colour]  Group urls that match a regular expression\n\n");
 
     printf("  --paddle-mode MODE         Paddle mode (single, pid, vhost)\n");
@@ -103,6 +117,8 @@ void logstalgia_help() {
     printf("  --glow-multiplier          Adjust the amount of glow (default: 1.25)\n");
     printf("  --glow-intensity           Intensity of the glow (default: 0.5)\n\n");
 
+    printf("  --quarantine FILE          Append lines that could not be parsed to a file\n\n");
+
     printf("  --output-ppm-stream FILE Write frames as PPM to a file ('-' for STDOUT)\n");
     printf("  --output-framerate FPS   Framerate of output (25,30,60)\n\n");
 
@@ -125,6 +141,11 @@ Logstalgia::Logstalgia(std::string logfile, float simu_speed, float update_rate)
     this->simu_speed  = simu_speed;
     this->update_rate = update_rate;
 
+    log_speed  = std::max(gAdaptiveMinSpeed, std::min(gAdaptiveMaxSpeed, simu_speed));
+    spawn_rate = 0.0f;
+    frame_time = 0.0f;
+    spawned    = 0;
+
     this->logfile = logfile;
 
     spawn_delay=0;
@@ -134,6 +155,7 @@ Logstalgia::Logstalgia(std::string logfile, float simu_speed, float update_rate)
     uimessage_timer=0.0f;
 
     ipSummarizer  = 0;
+    heavyhitters  = 0;
 
     mintime       = gSyncLog ? time(0) : 0;
     seeklog       = 0;
@@ -162,6 +184,12 @@ Logstalgia::Logstalgia(std::string logfile, float simu_speed, float update_rate)
 
     total_entries=0;
 
+    for(int i=0;i<LOG_ENTRY_ERROR_TYPES;i++) {
+        parse_errors[i] = 0;
+    }
+
+    quarantine = 0;
+
     background = vec3f(0.0, 0.0, 0.0);
 
     fontLarge  = fontmanager.grab("FreeSerif.ttf", 42);
@@ -188,6 +216,9 @@ Logstalgia::Logstalgia(std::string logfile, float simu_speed, float update_rate)
     frameskip = 0;
     fixed_tick_rate = 0.0;
 
+    sim_tick        = 1.0f / LOGSTALGIA_TICK_RATE;
+    sim_accumulator = 0.0f;
+
     accesslog = 0;
 
     font_alpha = 1.0;
@@ -218,10 +249,7 @@ Logstalgia::Logstalgia(std::string logfile, float simu_speed, float update_rate)
 Logstalgia::~Logstalgia() {
     if(accesslog!=0) delete accesslog;
 
-    for(std::map<std::string, Paddle*>::iterator it= paddles.begin(); it!=paddles.end();it++) {
-        delete it->second;
-    }
-    paddles.clear();
+    clearPaddles();
 
     if(seeklog!=0) delete seeklog;
     if(streamlog!=0) delete streamlog;
@@ -231,6 +259,9 @@ Logstalgia::~Logstalgia() {
         summGroups[i]=0;
     }
 
+    if(ipSummarizer!=0) delete ipSummarizer;
+
+    if(heavyhitters!=0) delete heavyhitters;
 }
 
 void Logstalgia::togglePause() {
@@ -310,22 +341,34 @@ void Logstalgia::reset() {
 
     highscore = 0;
 
-    for(std::map<std::string, Paddle*>::iterator it= paddles.begin(); it!=paddles.end();it++) {
-        delete it->second;
+    //balls hold on to their paddle, so remove them first
+    while(!balls.empty()) {
+        removeBall(balls.back());
     }
-    paddles.clear();
+
+    clearSpawnBatches();
+
+    clearPaddles();
 
     if(gPaddleMode <= PADDLE_SINGLE) {
         vec2f paddle_pos = vec2f(paddle_x - 20, rand() % display.height);
-        Paddle* paddle = new Paddle(paddle_pos, paddle_colour, "");
-        paddles[""] = paddle;
+        Paddle* paddle = new Paddle(paddle_pos, paddle_colour, InternedString());
+        addPaddle(paddle);
     }
 
-    for(std::list<RequestBall*>::iterator it = balls.begin(); it != balls.end(); it++) {
-        removeBall(*it);
-    }
+    //hosts are kept until they stop being among the busiest, so start again
+    if(heavyhitters != 0) {
+        std::vector<InternedString> hosts;
+        std::vector<unsigned int> seen;
+
+        heavyhitters->getTracked(hosts, seen);
 
-    balls.clear();
+        for(size_t i=0;i<hosts.size();i++) {
+            ipSummarizer->removeString(hosts[i], seen[i]);
+        }
+
+        heavyhitters->clear();
+    }
 
     ipSummarizer->recalc_display();
 
@@ -333,6 +376,10 @@ void Logstalgia::reset() {
         summGroups[i]->recalc_display();
     }
 
+    for(std::list<LogEntry*>::iterator it = queued_entries.begin(); it != queued_entries.end(); it++) {
+        delete *it;
+    }
+
     queued_entries.clear();
 
     // reset settings
@@ -429,84 +476,179 @@ std::string Logstalgia::filterURLHostname(const std::string& hostname) {
     return hostname;
 }
 
-void Logstalgia::addStrings(LogEntry* le) {
+//find the group for the url and the url as it will be displayed,
+//done once per entry so spawning and removing balls need no regex matching
+bool Logstalgia::classifyEntry(LogEntry* le) {
+
+    const std::string& pageurl = le->path;
+
+    le->group = groupClassifier.classify(pageurl);
+
+    if(le->group == -1) return false;
+
+    if(gHideURLPrefix) {
+        le->display_path = filterURLHostname(pageurl);
+    } else {
+        le->display_path = le->path;
+    }
+
+    return true;
+}
+
+//keeps the handles of the strings added, so the ball can remove them
+void Logstalgia::addStrings(LogEntry* le, std::vector<SummHandle>& handles) {
 
-    std::string hostname = le->hostname;
-    std::string pageurl  = le->path;
+    handles.push_back(summGroups[le->group]->addString(le->display_path));
 
-    int nogroups = summGroups.size();
-    Summarizer* pageSummarizer= 0;
+    //count every request from a host while it is one of the busiest,
+    //dropping its counts once it is replaced by another
+    if(heavyhitters != 0) {
+        InternedString evicted;
+        unsigned int evicted_seen;
 
-    for(int i=0;i<nogroups;i++) {
-        if(summGroups[i]->supportedString(pageurl)) {
-            pageSummarizer = summGroups[i];
-            break;
+        if(heavyhitters->add(le->hostname, evicted, evicted_seen)) {
+            ipSummarizer->removeString(evicted, evicted_seen);
         }
     }
 
-    if(pageSummarizer==0) return;
+    //counts of the busiest hosts are only dropped when they are replaced
+    handles.push_back(ipSummarizer->addString(le->hostname, heavyhitters == 0));
+}
+
+//the summaries used to place the batch have been published
+bool Logstalgia::isSummarized(const SpawnBatch& batch) {
+    int nogrps = summGroups.size();
 
-    if(gHideURLPrefix) pageurl = filterURLHostname(pageurl);
+    for(int i=0;i<nogrps;i++) {
+        if(!summGroups[i]->isSummarized(batch.summarized[i])) return false;
+    }
 
-    pageSummarizer->addString(pageurl);
-    ipSummarizer->addString(hostname);
+    return ipSummarizer->isSummarized(batch.summarized[nogrps]);
 }
 
-void Logstalgia::addBall(LogEntry* le, float start_offset) {
+void Logstalgia::spawnBatch(const SpawnBatch& batch) {
+
+    int items_to_spawn = batch.entries.size();
 
-    std::string hostname = le->hostname;
-    std::string pageurl  = le->path;
+    float item_offset = 1.0 / (float) (items_to_spawn);
 
-    //find appropriate summarizer for url
-    int nogroups = summGroups.size();
-    Summarizer* pageSummarizer= 0;
+    //above the merge rate, similar requests this second share a ball
+    bool merge = gMergeRate > 0 && items_to_spawn > gMergeRate;
 
-    for(int i=0;i<nogroups;i++) {
-        if(summGroups[i]->supportedString(pageurl)) {
-            pageSummarizer = summGroups[i];
-            break;
+    std::map<MergeKey, RequestBall*> merged;
+
+    for(int item_no=0;item_no<items_to_spawn;item_no++) {
+
+        LogEntry* le = batch.entries[item_no];
+
+        float pos_offset   = 1.0 - item_offset * (float) item_no;
+        float start_offset = std::min(1.0f, pos_offset);
+
+        SummHandle path_handle = batch.handles[item_no*2];
+        SummHandle host_handle = batch.handles[item_no*2+1];
+
+        //look up each summary position once
+        int page_match = summGroups[le->group]->getBestMatchIndex(le->display_path);
+        int ip_match   = ipSummarizer->getBestMatchIndex(le->hostname);
+
+        if(!merge) {
+            addBall(le, start_offset, page_match, ip_match, path_handle, host_handle);
+            continue;
+        }
+
+        MergeKey key;
+        key.group          = le->group;
+        key.page_row       = page_match;
+        key.host_row       = ip_match;
+        key.paddle_id      = gPaddleMode == PADDLE_VHOST ? le->vhost.getId() : gPaddleMode == PADDLE_PID ? le->pid.getId() : 0;
+        key.response_class = le->response_code.empty() ? 0 : le->response_code.str()[0];
+
+        std::map<MergeKey, RequestBall*>::iterator mit = merged.find(key);
+
+        if(mit != merged.end()) {
+            highscore += mit->second->merge(le, path_handle, host_handle);
+        } else {
+            merged[key] = addBall(le, start_offset, page_match, ip_match, path_handle, host_handle);
+        }
+    }
+}
+
+//drop requests not yet placed, removing their strings
+void Logstalgia::clearSpawnBatches() {
+
+    for(std::list<SpawnBatch>::iterator it = spawn_batches.begin(); it != spawn_batches.end(); it++) {
+        SpawnBatch& batch = *it;
+
+        for(size_t i=0;i<batch.entries.size();i++) {
+            LogEntry* le = batch.entries[i];
+
+            summGroups[le->group]->removeString(batch.handles[i*2]);
+
+            if(batch.handles[i*2+1] != 0) ipSummarizer->removeString(batch.handles[i*2+1]);
+
+            delete le;
         }
     }
 
-    if(pageSummarizer==0) return;
+    spawn_batches.clear();
+}
+
+RequestBall* Logstalgia::addBall(LogEntry* le, float start_offset, int page_match, int ip_match, SummHandle path_handle, SummHandle host_handle) {
+
+    Summarizer* pageSummarizer = summGroups[le->group];
 
     Paddle* entry_paddle = 0;
 
     if(gPaddleMode > PADDLE_SINGLE) {
 
-        std::string paddle_token = (gPaddleMode == PADDLE_VHOST) ? le->vhost : le->pid;
+        const InternedString& paddle_token = (gPaddleMode == PADDLE_VHOST) ? le->vhost : le->pid;
 
-        entry_paddle = paddles[paddle_token];
+        entry_paddle = getPaddle(paddle_token);
 
         if(entry_paddle == 0) {
             vec2f paddle_pos = vec2f(display.width-(display.width/3), rand() % display.height);
-            Paddle* paddle = new Paddle(paddle_pos, paddle_colour, paddle_token);
-            entry_paddle = paddles[paddle_token] = paddle;
+            entry_paddle = new Paddle(paddle_pos, paddle_colour, paddle_token);
+            addPaddle(entry_paddle);
         }
 
     } else {
-        entry_paddle = paddles[""];
+        entry_paddle = getPaddle(InternedString());
     }
 
-    if(gHideURLPrefix) pageurl = filterURLHostname(pageurl);
-
-    float dest_y = pageSummarizer->getMiddlePosY(pageurl);
-    float pos_y  = ipSummarizer->getMiddlePosY(hostname);
+    float dest_y = pageSummarizer->calcMiddlePosY(page_match);
+    float pos_y  = ipSummarizer->calcMiddlePosY(ip_match);
 
     float start_x = -(entry_paddle->getX()/ 5.0f);
 
     vec2f ball_start = vec2f(start_x, pos_y);
     vec2f ball_dest  = vec2f(entry_paddle->getX(), dest_y);
 
-    const std::string& match = ipSummarizer->getBestMatchStr(hostname);
+    const std::string& match = ipSummarizer->getStr(ip_match);
 
     vec3f colour = pageSummarizer->isColoured() ? pageSummarizer->getColour() : colourHash(match);
 
     RequestBall* ball = new RequestBall(le, &fontMedium, balltex, colour, ball_start, ball_dest, simu_speed);
 
-    ball->setElapsed( start_offset );
+    spawned++;
+
+    //balls starting part way along their path may already be on the screen
+    highscore += ball->setElapsed( start_offset );
 
+    ball->path_handle = path_handle;
+    ball->host_handle = host_handle;
+
+    ball->index = balls.size();
     balls.push_back(ball);
+
+    ball->paddle = entry_paddle;
+    entry_paddle->addBall();
+
+    //failed requests are not hit by the paddle
+    if(le->successful) {
+        entry_paddle->getArrivals().push(ball, ballstore.getClock() + ball->arrivalTime());
+    }
+
+    return ball;
 }
 
 BaseLog* Logstalgia::getLog() {
@@ -526,6 +668,7 @@ void Logstalgia::readLog(int buffer_rows) {
     int entries_read = 0;
 
     std::string linestr;
+    std::string full_line;
     BaseLog* baselog = getLog();
 
     time_t read_timestamp = 0;
@@ -544,16 +687,31 @@ void Logstalgia::readLog(int buffer_rows) {
             }
         }
 
-        LogEntry le;
+        bool truncated = false;
+
+        //cap the cost of parsing any one line
+        if(linestr.size() > LOGSTALGIA_MAX_LINE_LENGTH) {
+
+            //quarantine the line as it was read, not the part parsed
+            if(quarantine != 0) full_line = linestr;
+
+            linestr.resize(LOGSTALGIA_MAX_LINE_LENGTH);
+            parse_errors[LOG_ENTRY_TOO_LONG]++;
+            truncated = true;
+        }
+
+        //parse directly into a pooled entry
+        LogEntry* le = new LogEntry();
 
         bool parsed_entry;
+        int error = LOG_ENTRY_BAD_FORMAT;
 
         //determine format
         if(accesslog==0) {
 
             //is this a recognized NCSA access log?
             NCSALog* ncsalog = new NCSALog();
-            if((parsed_entry = ncsalog->parseLine(linestr, le))) {
+            if((parsed_entry = ncsalog->parseLine(linestr, *le))) {
                 accesslog = ncsalog;
             } else {
                 delete ncsalog;
@@ -562,7 +720,7 @@ void Logstalgia::readLog(int buffer_rows) {
             if(accesslog==0) {
                 //is this a custom log?
                 CustomAccessLog* customlog = new CustomAccessLog();
-                if((parsed_entry = customlog->parseLine(linestr, le))) {
+                if((parsed_entry = customlog->parseLine(linestr, *le))) {
                     accesslog = customlog;
                 } else {
                     delete customlog;
@@ -571,31 +729,40 @@ void Logstalgia::readLog(int buffer_rows) {
 
         } else {
 
-            if(!(parsed_entry = accesslog->parseLine(linestr, le))) {
-                debugLog("error: could not read line %s\n", linestr.c_str());
+            if(!(parsed_entry = accesslog->parseLine(linestr, *le))) {
+                error = accesslog->error;
             }
         }
 
-        if(parsed_entry) {
+        if(!parsed_entry) {
+            //one reason per line, a line cut short was counted as too long
+            if(!truncated) parse_errors[error]++;
 
-            if(mintime == 0 || mintime <= le.timestamp) {
+            if(quarantine != 0) quarantine->writeLine(truncated ? full_line : linestr);
+            delete le;
+            continue;
+        }
 
-                queued_entries.push_back(new LogEntry(le));
+        if((mintime != 0 && le->timestamp < mintime) || !classifyEntry(le)) {
+            if(!truncated) parse_errors[LOG_ENTRY_FILTERED]++;
+            delete le;
+            continue;
+        }
 
-                total_entries++;
-                entries_read++;
+        queued_entries.push_back(le);
 
-                //read at least the buffered row count if specified
-                //otherwise read all entries with the same time
-                if(buffer_rows) {
-                    if(entries_read > buffer_rows) break;
-                } else {
-                    if(read_timestamp && read_timestamp < le.timestamp) break;
-                }
+        total_entries++;
+        entries_read++;
 
-                read_timestamp = le.timestamp;
-            }
+        //read at least the buffered row count if specified
+        //otherwise read all entries with the same time
+        if(buffer_rows) {
+            if(entries_read > buffer_rows) break;
+        } else {
+            if(read_timestamp && read_timestamp < le->timestamp) break;
         }
+
+        read_timestamp = le->timestamp;
     }
 
     profile_stop();
@@ -649,9 +816,14 @@ void Logstalgia::init() {
 
     ipSummarizer = new Summarizer(fontSmall, 2, 40, 0, 2.0f);
 
-    reset();
+    if(gCIDRSummary) ipSummarizer->groupAddresses(true);
 
-    readLog();
+    if(gHeavyHitters > 0) {
+        heavyhitters = new HeavyHitters(gHeavyHitters);
+        ipSummarizer->showCount(true);
+    }
+
+    reset();
 
     //add default groups
     if(summGroups.size()==0) {
@@ -666,6 +838,9 @@ void Logstalgia::init() {
         addGroup(summGroups.size()>0 ? "Misc" : "", ".*");
     }
 
+    //entries are assigned to groups as they are read
+    readLog();
+
     SDL_ShowCursor(false);
 
     //set start position
@@ -693,22 +868,85 @@ void Logstalgia::setFrameExporter(FrameExporter* exporter, int video_framerate)
 
     this->fixed_tick_rate = 1.0f / ((float) fixed_framerate);
 
+    //step once per frame so the video does not depend on the tick rate
+    this->sim_tick = fixed_tick_rate;
+
     this->frameExporter = exporter;
 }
 
+void Logstalgia::setQuarantine(AsyncWriter* quarantine) {
+    this->quarantine = quarantine;
+}
+
+//ease the log speed towards spawning the target number of balls per
+//second, and slow down further while frames are taking too long.
+//frame_dt is the time the frame actually took to draw
+void Logstalgia::adaptSpeed(float dt, float frame_dt) {
+
+    if(dt <= 0.0f) return;
+
+    //averaged over about a second
+    float smoothing = std::min(1.0f, dt);
+
+    spawn_rate += ((float) spawned / dt - spawn_rate) * smoothing;
+    frame_time += (frame_dt - frame_time) * std::min(1.0f, frame_dt);
+
+    spawned = 0;
+
+    float target_speed = gAdaptiveMaxSpeed;
+
+    if(spawn_rate > 0.0f) {
+        target_speed = log_speed * (float) gAdaptiveSpawnRate / spawn_rate;
+    }
+
+    //a video is not played back at the speed it is drawn at
+    if(frameExporter == 0 && frame_time > LOGSTALGIA_FRAME_BUDGET) {
+        target_speed = std::min(target_speed, log_speed * LOGSTALGIA_FRAME_BUDGET / frame_time);
+    }
+
+    log_speed += (target_speed - log_speed) * std::min(1.0f, dt * 0.5f);
+
+    log_speed = std::max(gAdaptiveMinSpeed, std::min(gAdaptiveMaxSpeed, log_speed));
+}
+
 void Logstalgia::update(float t, float dt) {
 
+    float frame_dt = dt;
+
     //if exporting a video use a fixed tick rate rather than time based
     if(frameExporter != 0) {
         dt = fixed_tick_rate;
+    } else {
+        dt = std::min(dt, LOGSTALGIA_MAX_FRAME_TIME);
     }
 
+    if(gAdaptiveSpeed && !paused) adaptSpeed(dt, frame_dt);
+
     dt *= time_scale;
 
-    //have to manage runtime internally as we're messing with dt
-    runtime += dt;
+    if(paused) {
+        //nothing moves, so keep drawing at the same point between steps
+        runtime += dt;
+
+        logic(runtime, dt);
+    } else {
+        //simulate in fixed steps, carrying what is left over to the next frame
+        sim_accumulator += dt;
+
+        while(sim_accumulator >= sim_tick) {
+
+            //have to manage runtime internally as we're messing with dt
+            runtime += sim_tick;
+
+            logic(runtime, sim_tick);
+
+            sim_accumulator -= sim_tick;
+        }
+
+        //draw balls and paddles between their positions at the last two steps
+        ballstore.setLag(sim_tick - sim_accumulator);
+    }
 
-    logic(runtime, dt);
     draw(runtime, dt);
 
     //extract frames based on frameskip setting
@@ -722,53 +960,84 @@ void Logstalgia::update(float t, float dt) {
    framecount++;
 }
 
-RequestBall* Logstalgia::findNearest(Paddle* paddle, const std::string& paddle_token) {
+Paddle* Logstalgia::getPaddle(const InternedString& token) {
+    unsigned int id = token.getId();
 
-    float min_dist = -1.0f;
-    RequestBall* nearest = 0;
+    if(id >= paddle_ids.size()) return 0;
 
-    for(std::list<RequestBall*>::iterator it = balls.begin(); it != balls.end(); it++) {
-        RequestBall* ball = *it;
+    return paddle_ids[id];
+}
 
-        //special case if failed response code
-        if(!ball->le->successful) {
-            continue;
-        }
+void Logstalgia::addPaddle(Paddle* paddle) {
+    unsigned int id = paddle->getToken().getId();
 
-        if(ball->le->successful && !ball->hasBounced()
-            && (gPaddleMode <= PADDLE_SINGLE
-                || gPaddleMode == PADDLE_VHOST && ball->le->vhost == paddle_token
-                || gPaddleMode == PADDLE_PID   && ball->le->pid   == paddle_token
-               )
-            ) {
-            float dist = (paddle->getX() - ball->getX())/ball->speed;
-            if(min_dist<0.0f || dist<min_dist) {
-                min_dist = dist;
-                nearest = ball;
-            }
-        }
+    if(id >= paddle_ids.size()) paddle_ids.resize(id+1, 0);
+
+    paddle_ids[id] = paddle;
+    paddles.push_back(paddle);
+}
+
+//replaces the paddle with the last one
+void Logstalgia::removePaddle(size_t i) {
+    Paddle* paddle = paddles[i];
+
+    paddle_ids[paddle->getToken().getId()] = 0;
+
+    paddles[i] = paddles.back();
+    paddles.pop_back();
+
+    delete paddle;
+}
+
+void Logstalgia::clearPaddles() {
+    for(std::vector<Paddle*>::iterator it = paddles.begin(); it != paddles.end(); it++) {
+        delete *it;
     }
+    paddles.clear();
+    paddle_ids.clear();
+}
+
+//the next ball to arrive at the paddle which has not already bounced
+RequestBall* Logstalgia::findNearest(Paddle* paddle) {
+
+    ArrivalQueue& arrivals = paddle->getArrivals();
+
+    //balls are left in the queue when they bounce, so drop any at the front
+    while(!arrivals.empty() && arrivals.top()->hasBounced()) {
+        arrivals.pop();
+    }
+
+    if(arrivals.empty()) return 0;
 
-    return nearest;
+    return arrivals.top();
 }
 
 void Logstalgia::removeBall(RequestBall* ball) {
-    std::string url  = ball->le->path;
-    std::string host = ball->le->hostname;
 
-    int nogroups = summGroups.size();
+    //fill the gap with the last ball
+    RequestBall* last = balls.back();
+    balls[ball->index] = last;
+    last->index = ball->index;
+    balls.pop_back();
 
-    for(int i=0;i<nogroups;i++) {
-        if(summGroups[i]->supportedString(url)) {
+    if(ball->queue != 0) ball->queue->remove(ball);
 
-            if(gHideURLPrefix) url = filterURLHostname(url);
+    ball->paddle->removeBall();
 
-            summGroups[i]->removeString(url);
-            break;
-        }
-    }
+    Summarizer* pageSummarizer = summGroups[ball->le->group];
+
+    pageSummarizer->removeString(ball->path_handle);
+
+    if(ball->host_handle != 0) ipSummarizer->removeString(ball->host_handle);
+
+    //requests merged into the ball are all in the same group
+    const std::vector<SummHandle>& merged_handles = ball->getMergedHandles();
+
+    for(size_t i=0;i<merged_handles.size();i+=2) {
+        pageSummarizer->removeString(merged_handles[i]);
 
-    ipSummarizer->removeString(host);
+        if(merged_handles[i+1] != 0) ipSummarizer->removeString(merged_handles[i+1]);
+    }
 
     delete ball;
 }
@@ -787,7 +1056,7 @@ void Logstalgia::logic(float t, float dt) {
 
     infowindow.hide();
 
-    if(end_reached && balls.empty()) {
+    if(end_reached && balls.empty() && spawn_batches.empty()) {
         appFinished = true;
         return;
     }
@@ -795,16 +1064,15 @@ void Logstalgia::logic(float t, float dt) {
     //if paused, dont move anything, only check what is under mouse
     if(paused) {
 
-        for(std::map<std::string, Paddle*>::iterator it= paddles.begin(); it!=paddles.end();it++) {
-            std::string paddle_token = it->first;
-            Paddle*           paddle = it->second;
+        for(std::vector<Paddle*>::iterator it= paddles.begin(); it!=paddles.end();it++) {
+            Paddle* paddle = *it;
 
-            if(paddle->mouseOver(infowindow, mousepos)) {
+            if(paddle->mouseOver(infowindow, mousepos, getStepLag())) {
                 break;
             }
         }
 
-        for(std::list<RequestBall*>::iterator it = balls.begin(); it != balls.end(); it++) {
+        for(std::vector<RequestBall*>::iterator it = balls.begin(); it != balls.end(); it++) {
             RequestBall* ball = *it;
             if(ball->mouseOver(infowindow, mousepos)) {
                 break;
@@ -822,12 +1090,12 @@ void Logstalgia::logic(float t, float dt) {
     }
 
     //increment clock
-    elapsed_time += sdt;
+    elapsed_time += gAdaptiveSpeed ? dt * log_speed : sdt;
     currtime = starttime + (long)(elapsed_time);
 
     //next will fast forward clock to the time of the next entry, 
     //if the next entry is in the future
-    if(next || gAutoSkip && balls.empty()) {
+    if(next || gAutoSkip && balls.empty() && spawn_batches.empty()) {
         if(!queued_entries.empty()) {
             LogEntry* le = queued_entries.front();
 
@@ -850,57 +1118,40 @@ void Logstalgia::logic(float t, float dt) {
 
         profile_start("determine new entries");
 
-        int items_to_spawn=0;
+        spawn_batches.push_back(SpawnBatch());
+
+        SpawnBatch& batch = spawn_batches.back();
 
-        for(std::list<LogEntry*>::iterator it = queued_entries.begin(); it != queued_entries.end(); it++) {
-            LogEntry* le = *it;
+        while(!queued_entries.empty()) {
+            LogEntry* le = queued_entries.front();
 
             if(le->timestamp > currtime) break;
 
-            items_to_spawn++;
+            queued_entries.pop_front();
 
-            addStrings(le);
+            batch.entries.push_back(le);
+
+            addStrings(le, batch.handles);
         }
 
         profile_stop();
 
-        //debugLog("items to spawn %d\n", items_to_spawn);
-
-        if(items_to_spawn > 0) {
+        if(!batch.entries.empty()) {
 
             profile_start("add new strings");
 
-            //re-summarize
-            ipSummarizer->summarize();
-
+            //re-summarize, the entries are placed once the summaries are published
             int nogrps = summGroups.size();
 
             for(int i=0;i<nogrps;i++) {
-                summGroups[i]->summarize();
+                batch.summarized.push_back(summGroups[i]->summarize());
             }
 
-            profile_stop();
-
-            profile_start("add new entries");
-
-            float item_offset = 1.0 / (float) (items_to_spawn);
-
-            int item_no = 0;
-            
-            while(!queued_entries.empty()) {
-
-                LogEntry* le = queued_entries.front();
-
-                if(le->timestamp > currtime) break;
-
-                float pos_offset   = 1.0 - item_offset * (float) item_no++;
-                float start_offset = std::min(1.0f, pos_offset);
-
-		addBall(le, start_offset);
-
-                queued_entries.pop_front();
-            }
+            batch.summarized.push_back(ipSummarizer->summarize());
 
+            profile_stop();
+        } else {
+            spawn_batches.pop_back();
         }
 
         //update date
@@ -929,35 +1180,15 @@ void Logstalgia::logic(float t, float dt) {
         }
     }
 
-    std::list<Paddle*> inactivePaddles;
-
     //update paddles
-    for(std::map<std::string, Paddle*>::iterator it= paddles.begin(); it!=paddles.end();it++) {
-
-        std::string paddle_token = it->first;
-        Paddle*           paddle = it->second;
-
-        if(gPaddleMode > PADDLE_SINGLE && !paddle->moving() && !paddle->visible()) {
-
-            bool token_match = false;
-
-            //are there any requests that will match this paddle?
-            for(std::list<RequestBall*>::iterator bit = balls.begin(); bit != balls.end();bit++) {
+    for(size_t i=0;i<paddles.size();) {
 
-                RequestBall* ball = *bit;
+        Paddle* paddle = paddles[i];
 
-                if(   gPaddleMode == PADDLE_VHOST && ball->le->vhost == paddle_token
-                   || gPaddleMode == PADDLE_PID   && ball->le->pid   == paddle_token) {
-                    token_match = true;
-                    break;
-                }
-            }
-
-            //mark this paddle for deletion, continue
-            if(!token_match) {
-                inactivePaddles.push_back(paddle);
-                continue;
-            }
+        //reclaim paddles with no requests left once they have faded out
+        if(gPaddleMode > PADDLE_SINGLE && paddle->getBallCount() == 0 && !paddle->moving() && !paddle->visible()) {
+            removePaddle(i);
+            continue;
         }
 
         // find nearest ball to this paddle
@@ -965,7 +1196,7 @@ void Logstalgia::logic(float t, float dt) {
 
             recentre=false;
 
-            RequestBall* ball = findNearest(paddle, paddle_token);
+            RequestBall* ball = findNearest(paddle);
 
             if(ball!=0 && !(paddle->moving() && paddle->getTarget() == ball)) {
                 paddle->setTarget(ball);
@@ -979,27 +1210,31 @@ void Logstalgia::logic(float t, float dt) {
             paddle->setTarget(0);
         }
 
-        it->second->logic(sdt);
+        paddle->logic(sdt);
+
+        i++;
     }
 
     recentre = false;
 
     profile_start("check ball status");
 
-    for(std::list<RequestBall*>::iterator it = balls.begin(); it != balls.end();) {
+    //move all the balls along together, scoring those coming onto the screen
+    highscore += ballstore.update(dt, arrived_balls);
 
-        RequestBall* ball = *it;
+    for(std::vector<ProjectedBall*>::iterator it = arrived_balls.begin(); it != arrived_balls.end(); it++) {
 
-        highscore += ball->logic(dt);
+        RequestBall* ball = static_cast<RequestBall*>(*it);
 
-        if(ball->isFinished()) {
-            it = balls.erase(it);
-            removeBall(ball);
+        if(!ball->hasBounced()) {
+            ball->bounce();
         } else {
-            it++;
+            removeBall(ball);
         }
     }
 
+    arrived_balls.clear();
+
     profile_stop();
 
     profile_start("ipSummarizer logic");
@@ -1010,6 +1245,15 @@ void Logstalgia::logic(float t, float dt) {
     updateGroups(dt);
     profile_stop();
 
+    profile_start("add new entries");
+
+    while(!spawn_batches.empty() && isSummarized(spawn_batches.front())) {
+        spawnBatch(spawn_batches.front());
+        spawn_batches.pop_front();
+    }
+
+    profile_stop();
+
 
     screen_blank_elapsed += dt;
 
@@ -1081,6 +1325,7 @@ void Logstalgia::addGroup(std::string grouptitle, std::string groupregex, int pe
     }
 
     summGroups.push_back(summ);
+    groupClassifier.addGroup(groupregex);
 
     remaining_space -= space;
 }
@@ -1140,7 +1385,7 @@ void Logstalgia::draw(float t, float dt) {
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glBindTexture(GL_TEXTURE_2D, balltex->textureid);
 
-    for(std::list<RequestBall*>::iterator it = balls.begin(); it != balls.end(); it++) {
+    for(std::vector<RequestBall*>::iterator it = balls.begin(); it != balls.end(); it++) {
         (*it)->draw(dt);
     }
 
@@ -1148,7 +1393,7 @@ void Logstalgia::draw(float t, float dt) {
 
     profile_start("draw response codes");
 
-    for(std::list<RequestBall*>::iterator it = balls.begin(); it != balls.end(); it++) {
+    for(std::vector<RequestBall*>::iterator it = balls.begin(); it != balls.end(); it++) {
         RequestBall* r = *it;
 
         if(gResponseCode && r->hasBounced()) {
@@ -1165,13 +1410,13 @@ void Logstalgia::draw(float t, float dt) {
     if(gPaddleMode != PADDLE_NONE) {
 
         //draw paddles shadows
-        for(std::map<std::string, Paddle*>::iterator it= paddles.begin(); it!=paddles.end();it++) {
-            it->second->drawShadow();
+        for(std::vector<Paddle*>::iterator it= paddles.begin(); it!=paddles.end();it++) {
+            (*it)->drawShadow(getStepLag());
         }
 
         //draw paddles
-        for(std::map<std::string, Paddle*>::iterator it= paddles.begin(); it!=paddles.end();it++) {
-            it->second->draw();
+        for(std::vector<Paddle*>::iterator it= paddles.begin(); it!=paddles.end();it++) {
+            (*it)->draw(getStepLag());
         }
 
     }
@@ -1185,7 +1430,7 @@ void Logstalgia::draw(float t, float dt) {
 
         glBindTexture(GL_TEXTURE_2D, glowtex->textureid);
 
-        for(std::list<RequestBall*>::iterator it = balls.begin(); it != balls.end(); it++) {
+        for(std::vector<RequestBall*>::iterator it = balls.begin(); it != balls.end(); it++) {
             (*it)->drawGlow();
         }
     }
@@ -1252,9 +1497,25 @@ void Logstalgia::draw(float t, float dt) {
         fontMedium.print(2,19,"Balls %03d", balls.size());
         fontMedium.print(2,36,"Queue %03d", queued_entries.size());
         fontMedium.print(2,53,"Paddles %03d", paddles.size());
+        fontMedium.print(2,70, "Bad Format  %03d", parse_errors[LOG_ENTRY_BAD_FORMAT]);
+        fontMedium.print(2,87, "Bad Date    %03d", parse_errors[LOG_ENTRY_BAD_DATE]);
+        fontMedium.print(2,104,"Bad Request %03d", parse_errors[LOG_ENTRY_BAD_REQUEST]);
+        fontMedium.print(2,121,"Invalid     %03d", parse_errors[LOG_ENTRY_INVALID]);
+        fontMedium.print(2,138,"Too Long    %03d", parse_errors[LOG_ENTRY_TOO_LONG]);
+        fontMedium.print(2,155,"Filtered    %03d", parse_errors[LOG_ENTRY_FILTERED]);
+        fontMedium.print(2,172,"Pooled      %03d", slaballocator.getLive());
+        fontMedium.print(2,189,"Pool Reuse  %d%%", slaballocator.getAllocations() > 0 ? (int) (100.0 * slaballocator.getReused() / slaballocator.getAllocations()) : 0);
+        fontMedium.print(2,206,"Pool Size   %dK", (int) (slaballocator.getReserved() / 1024));
+
+        if(heavyhitters != 0) {
+            fontMedium.print(2,223,"Top Hosts   %d/%d", (int) heavyhitters->size(), (int) heavyhitters->getCapacity());
+            fontMedium.print(2,240,"Host Error  +%d", heavyhitters->getMaxUntracked());
+        }
     } else {
         fontMedium.draw(2,2,  displaydate.c_str());
         fontMedium.draw(2,19, displaytime.c_str());
+
+        if(gAdaptiveSpeed) fontMedium.print(2,36, "Speed %.2fx", log_speed);
     }
     glColor4f(1,1,1,font_alpha);
 
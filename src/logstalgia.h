@@ -20,6 +20,19 @@
 
 #define LOGSTALGIA_VERSION "1.0.4"
 
+//longer lines are truncated before parsing. servers limit the request line
+//and each header to about 8KB by default, so valid entries fit
+#define LOGSTALGIA_MAX_LINE_LENGTH 32768
+
+//steps per second the simulation is advanced at, independent of the frame rate
+#define LOGSTALGIA_TICK_RATE 60
+
+//longest frame time simulated, so a stall is not followed by a burst of steps
+#define LOGSTALGIA_MAX_FRAME_TIME 0.25f
+
+//frame time above which --adaptive-speed slows the log down
+#define LOGSTALGIA_FRAME_BUDGET (2.0f / LOGSTALGIA_TICK_RATE)
+
 #ifdef _WIN32
 #include "windows.h"
 #endif
@@ -35,9 +48,12 @@
 #include "paddle.h"
 #include "requestball.h"
 #include "summarizer.h"
+#include "heavyhitters.h"
+#include "groupclassifier.h"
 #include "textarea.h"
 #include "slider.h"
 #include "ppm.h"
+#include "asyncwriter.h"
 
 #include <unistd.h>
 
@@ -56,6 +72,13 @@ extern bool  gSyncLog;
 extern bool  gResponseCode;
 extern bool  gDisableProgress;
 extern bool  gHideURLPrefix;
+extern int   gHeavyHitters;
+extern bool  gCIDRSummary;
+extern int   gMergeRate;
+extern bool  gAdaptiveSpeed;
+extern float gAdaptiveMinSpeed;
+extern float gAdaptiveMaxSpeed;
+extern int   gAdaptiveSpawnRate;
 extern float gSplash;
 extern float gStartPosition;
 extern float gStopPosition;
@@ -68,9 +91,45 @@ void logstalgia_info(std::string msg);
 void logstalgia_quit(std::string error);
 void logstalgia_help(std::string error);
 
+//requests spawned in the same second with the same key can share a ball
+
+class MergeKey {
+public:
+    int group;
+    int page_row;
+    int host_row;
+    unsigned int paddle_id;
+    char response_class;
+
+    bool operator<(const MergeKey& other) const {
+        if(group     != other.group)     return group     < other.group;
+        if(page_row  != other.page_row)  return page_row  < other.page_row;
+        if(host_row  != other.host_row)  return host_row  < other.host_row;
+        if(paddle_id != other.paddle_id) return paddle_id < other.paddle_id;
+        return response_class < other.response_class;
+    }
+};
+
+//requests from one second of the log, held until the summaries used to
+//place them include their strings
+
+class SpawnBatch {
+public:
+    std::vector<LogEntry*> entries;
+
+    //summarizer handles, two per entry
+    std::vector<SummHandle> handles;
+
+    //batch of changes each group summarizer, then the ip summarizer, must show
+    std::vector<unsigned int> summarized;
+};
+
 class Logstalgia : public SDLApp {
 
-    std::map<std::string,Paddle*> paddles;
+    std::vector<Paddle*> paddles;
+
+    //paddles by the string table id of their token
+    std::vector<Paddle*> paddle_ids;
 
     std::string logfile;
 
@@ -103,6 +162,15 @@ class Logstalgia : public SDLApp {
     float simu_speed;
     float update_rate;
 
+    //log seconds per second chosen by --adaptive-speed, with the
+    //smoothed balls spawned per second and frame time it is based on
+    float log_speed;
+    float spawn_rate;
+    float frame_time;
+    int   spawned;
+
+    void adaptSpeed(float dt, float frame_dt);
+
     float spawn_delay;
     float spawn_speed;
 
@@ -112,6 +180,9 @@ class Logstalgia : public SDLApp {
     int total_space;
     int remaining_space;
     int total_entries;
+    int parse_errors[LOG_ENTRY_ERROR_TYPES];
+
+    AsyncWriter* quarantine;
 
     vec3f background;
     vec4f paddle_colour;
@@ -131,7 +202,11 @@ class Logstalgia : public SDLApp {
 
     Summarizer* ipSummarizer;
 
+    //busiest hosts, when the ip summarizer is limited to them
+    HeavyHitters* heavyhitters;
+
     std::vector<Summarizer*> summGroups;
+    GroupClassifier groupClassifier;
 
     PositionSlider slider;
 
@@ -141,7 +216,11 @@ class Logstalgia : public SDLApp {
     StreamLog* streamlog;
 
     std::list<LogEntry*> queued_entries;
-    std::list<RequestBall*> balls;
+    std::list<SpawnBatch> spawn_batches;
+    std::vector<RequestBall*> balls;
+
+    //balls reaching the end of their path this frame
+    std::vector<ProjectedBall*> arrived_balls;
 
     TextArea infowindow;
 
@@ -149,24 +228,43 @@ class Logstalgia : public SDLApp {
 
     float runtime;
     float fixed_tick_rate;
+
+    //length of a simulation step, and time not yet simulated
+    float sim_tick;
+    float sim_accumulator;
+
     int framecount;
     int frameskip;
     FrameExporter* frameExporter;
 
     std::string filterURLHostname(const std::string& hostname);
 
+    bool classifyEntry(LogEntry* le);
+
     std::string dateAtPosition(float percent);
     void seekTo(float percent);
 
     void readLog(int buffer_rows = 0);
 
-    RequestBall* findNearest(Paddle* paddle, const std::string& paddle_token);
+    //fraction of a step the drawing is behind the simulation
+    float getStepLag() const { return ballstore.getLag() / sim_tick; }
+
+    RequestBall* findNearest(Paddle* paddle);
+
+    Paddle* getPaddle(const InternedString& token);
+    void addPaddle(Paddle* paddle);
+    void removePaddle(size_t i);
+    void clearPaddles();
     void updateGroups(float dt);
     void drawGroups(float dt, float alpha);
 
-    void addStrings(LogEntry* le);
+    void addStrings(LogEntry* le, std::vector<SummHandle>& handles);
+
+    bool isSummarized(const SpawnBatch& batch);
+    void spawnBatch(const SpawnBatch& batch);
+    void clearSpawnBatches();
 
-    void addBall(LogEntry* le,  float start_offset);
+    RequestBall* addBall(LogEntry* le, float start_offset, int page_match, int ip_match, SummHandle path_handle, SummHandle host_handle);
     void removeBall(RequestBall* ball);
     void addGroup(std::string grouptitle, std::string groupregex, int percent = 0, vec3f colour = vec3f(0.0f, 0.0f, 0.0f));
     void togglePause();
@@ -185,6 +283,8 @@ public:
 
     void setFrameExporter(FrameExporter* exporter, int video_framerate);
 
+    void setQuarantine(AsyncWriter* quarantine);
+
     void setBackground(vec3f background);
 
     //inherited methods
@@ -57,6 +57,7 @@ int main(int argc, char *argv[]) {
 
     int video_framerate = 60;
     std::string ppm_file_name;
+    std::string quarantine_file_name;
 
     std::string logfile = "";
 
@@ -86,6 +87,96 @@ int main(int argc, char *argv[]) {
             continue;
         }
 
+        if(args == "--ipv4-mask") {
+
+            if((i+1)>=arguments.size()) {
+                logstalgia_quit("specify ipv4-mask prefix bits (8 - 32)");
+            }
+
+            gMaskIPv4Bits = atoi(arguments[++i].c_str());
+
+            if(gMaskIPv4Bits < 8 || gMaskIPv4Bits > 32) {
+                logstalgia_quit("ipv4-mask outside of range 8 - 32");
+            }
+
+            continue;
+        }
+
+        if(args == "--ipv6-mask") {
+
+            if((i+1)>=arguments.size()) {
+                logstalgia_quit("specify ipv6-mask prefix bits (16 - 128)");
+            }
+
+            gMaskIPv6Bits = atoi(arguments[++i].c_str());
+
+            if(gMaskIPv6Bits < 16 || gMaskIPv6Bits > 128) {
+                logstalgia_quit("ipv6-mask outside of range 16 - 128");
+            }
+
+            continue;
+        }
+
+        if(args == "--heavy-hitters") {
+
+            if((i+1)>=arguments.size()) {
+                logstalgia_quit("specify number of hosts to track (10 - 1000000)");
+            }
+
+            gHeavyHitters = atoi(arguments[++i].c_str());
+
+            if(gHeavyHitters < 10 || gHeavyHitters > 1000000) {
+                logstalgia_quit("heavy-hitters outside of range 10 - 1000000");
+            }
+
+            continue;
+        }
+
+        if(args == "--merge-rate") {
+
+            if((i+1)>=arguments.size()) {
+                logstalgia_quit("specify requests per second to merge above (10 - 1000000)");
+            }
+
+            gMergeRate = atoi(arguments[++i].c_str());
+
+            if(gMergeRate < 10 || gMergeRate > 1000000) {
+                logstalgia_quit("merge-rate outside of range 10 - 1000000");
+            }
+
+            continue;
+        }
+
+        if(args == "--adaptive-speed") {
+
+            if((i+1)>=arguments.size()) {
+                logstalgia_quit("specify adaptive-speed range (MIN,MAX[,RATE])");
+            }
+
+            int fields = sscanf(arguments[++i].c_str(), "%f,%f,%d", &gAdaptiveMinSpeed, &gAdaptiveMaxSpeed, &gAdaptiveSpawnRate);
+
+            if(fields < 2) {
+                logstalgia_quit("invalid adaptive-speed range");
+            }
+
+            if(gAdaptiveMinSpeed < 0.1f || gAdaptiveMaxSpeed > 30.0f || gAdaptiveMinSpeed > gAdaptiveMaxSpeed) {
+                logstalgia_quit("adaptive-speed should be between 0.1 and 30");
+            }
+
+            if(gAdaptiveSpawnRate < 1 || gAdaptiveSpawnRate > 1000000) {
+                logstalgia_quit("adaptive-speed rate outside of range 1 - 1000000");
+            }
+
+            gAdaptiveSpeed = true;
+
+            continue;
+        }
+
+        if(args == "--cidr-summary") {
+            gCIDRSummary = true;
+            continue;
+        }
+
         if(args == "--hide-url-prefix") {
             gHideURLPrefix = true;
             continue;
@@ -339,6 +430,17 @@ int main(int argc, char *argv[]) {
             continue;
         }
 
+        if(args == "--quarantine") {
+
+            if((i+1)>=arguments.size()) {
+                logstalgia_quit("specify quarantine file");
+            }
+
+            quarantine_file_name = arguments[++i];
+
+            continue;
+        }
+
         if(args == "--output-framerate") {
 
             if((i+1)>=arguments.size()) {
@@ -428,6 +530,24 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    //write unparsable lines to the quarantine file
+    AsyncWriter* quarantine = 0;
+
+    if(quarantine_file_name.size() > 0) {
+
+        try {
+
+            quarantine = new AsyncWriter(quarantine_file_name);
+
+        } catch(AsyncWriterException& exception) {
+
+            char errormsg[1024];
+            snprintf(errormsg, 1024, "could not write to '%s'", exception.what());
+
+            logstalgia_quit(errormsg);
+        }
+    }
+
     if(multisample) glEnable(GL_MULTISAMPLE_ARB);
 
     Logstalgia* ls = 0;
@@ -444,6 +564,10 @@ int main(int argc, char *argv[]) {
             ls->addGroup(groupstr[i]);
         }
 
+        if(quarantine != 0) {
+            ls->setQuarantine(quarantine);
+        }
+
         ls->setBackground(background);
 
         ls->run();
@@ -469,6 +593,8 @@ int main(int argc, char *argv[]) {
 
     if(exporter!=0) delete exporter;
 
+    if(quarantine!=0) delete quarantine;
+
     display.quit();
 
     return 0;
@@ -26,9 +26,48 @@ Regex ls_ncsa_entry_agent("(?: +\"([^\"]+)\" +\"([^\"]+)\")?(?: +\([^ ]+))?");
 NCSALog::NCSALog() {
 }
 
+//single pass check that the line has the basic shape of an entry
+//(a [date] followed by a quoted request) before running any regexes on it
+bool NCSALog::validLine(const std::string& line) {
+
+    size_t line_size = line.size();
+
+    int stage = 0;
+
+    for(size_t i=0;i<line_size;i++) {
+        unsigned char c = line[i];
+
+        //binary junk
+        if(c < 0x20 && c != '\t') return false;
+
+        switch(stage) {
+            case 0:
+                if(c == '[') stage++;
+                break;
+            case 1:
+                if(c == ']') stage++;
+                break;
+            case 2:
+                if(c == '"') stage++;
+                break;
+            case 3:
+                if(c == '"') stage++;
+                break;
+            default:
+                break;
+        }
+    }
+
+    return stage == 4;
+}
+
 //parse NCSA format access.log entry into components
 bool NCSALog::parseLine(std::string& line, LogEntry& entry) {
 
+    error = LOG_ENTRY_BAD_FORMAT;
+
+    if(!validLine(line)) return 0;
+
     std::vector<std::string> matches;
     ls_ncsa_entry_start.match(line, &matches);
 
@@ -38,7 +77,7 @@ bool NCSALog::parseLine(std::string& line, LogEntry& entry) {
 
     //get details
     entry.vhost    = matches[0];
-    entry.hostname = matches[1];
+    entry.setHostname(matches[1]);
     //entry.username = matches[1];
 
     //parse timestamp
@@ -49,6 +88,8 @@ bool NCSALog::parseLine(std::string& line, LogEntry& entry) {
     std::string request_str = matches[4];
     std::string datestr     = matches[3];
 
+    error = LOG_ENTRY_BAD_DATE;
+
     matches.clear();
     ls_ncsa_entry_date.match(datestr, &matches);
 
@@ -101,6 +142,8 @@ bool NCSALog::parseLine(std::string& line, LogEntry& entry) {
     //apply utc offset
     entry.timestamp -= tz_offset;
 
+    error = LOG_ENTRY_BAD_REQUEST;
+
     matches.clear();
     ls_ncsa_entry_request.match(request_str, &matches);
 
@@ -112,8 +155,8 @@ bool NCSALog::parseLine(std::string& line, LogEntry& entry) {
     entry.path      = matches[1];
 //    entry.protocol  = matches[2];
 
-    entry.response_code = matches[3].c_str();
-    entry.response_size = atol(matches[4].c_str());
+    entry.setResponseCode(matches[3]);
+    entry.setResponseSize(matches[4]);
 
     if(matches.size() > 5) {
         std::string agentstr = matches[5];
@@ -128,11 +171,16 @@ bool NCSALog::parseLine(std::string& line, LogEntry& entry) {
     }
 
     //successful if response code less than 400
-    int code = atoi(entry.response_code.c_str());
-
     entry.setSuccess();
     entry.setResponseColour();
 
-    return entry.validate();
+    if(!entry.validate()) {
+        error = LOG_ENTRY_INVALID;
+        return 0;
+    }
+
+    error = LOG_ENTRY_OK;
+
+    return 1;
 }
 
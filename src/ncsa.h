@@ -22,6 +22,7 @@
 
 class NCSALog : public AccessLog {
 
+    bool validLine(const std::string& line);
 public:
     NCSALog();
     bool parseLine(std::string& line, LogEntry& entry);
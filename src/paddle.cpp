@@ -19,11 +19,12 @@
 
 int gPaddleMode = PADDLE_SINGLE;
 
-Paddle::Paddle(vec2f pos, vec4f colour, std::string token) {
+Paddle::Paddle(vec2f pos, vec4f colour, const InternedString& token) {
     this->token = token;
     this->token_colour = token.size() > 0 ? colourHash2(token) : vec3f(0.5,0.5,0.5);
 
     this->pos = pos;
+    this->last_pos = pos;
     this->lastcol = colour;
     this->default_colour = colour;
     this->colour  = lastcol;
@@ -31,6 +32,8 @@ Paddle::Paddle(vec2f pos, vec4f colour, std::string token) {
     this->height = 50;
     this->target = 0;
 
+    ball_count = 0;
+
     dest_y = -1;
 }
 
@@ -67,6 +70,18 @@ RequestBall* Paddle::getTarget() {
     return target;
 }
 
+ArrivalQueue& Paddle::getArrivals() {
+    return arrivals;
+}
+
+void Paddle::addBall() {
+    ball_count++;
+}
+
+void Paddle::removeBall() {
+    ball_count--;
+}
+
 void Paddle::setTarget(RequestBall* target) {
     this->target = target;
 
@@ -76,13 +91,20 @@ void Paddle::setTarget(RequestBall* target) {
     }
 
     vec2f dest = target->finish();
+    vec3f ball_colour = target->getColour();
     vec4f col  = (gPaddleMode == PADDLE_VHOST || gPaddleMode == PADDLE_PID)  ?
-        vec4f(token_colour,1.0) : vec4f(target->colour, 1.0f);
+        vec4f(token_colour,1.0) : vec4f(ball_colour, 1.0f);
 
     moveTo((int)dest.y, target->arrivalTime(), col);
 }
 
-bool Paddle::mouseOver(TextArea& textarea, vec2f& mouse) {
+vec2f Paddle::getDrawPos(float lag) const {
+    return pos + (last_pos - pos) * lag;
+}
+
+bool Paddle::mouseOver(TextArea& textarea, vec2f& mouse, float lag) {
+
+    vec2f pos = getDrawPos(lag);
 
     if(pos.x <= mouse.x && pos.x + width >= mouse.x && abs(pos.y - mouse.y) < height/2) {
 
@@ -102,6 +124,8 @@ bool Paddle::mouseOver(TextArea& textarea, vec2f& mouse) {
 
 void Paddle::logic(float dt) {
 
+    last_pos = pos;
+
     if(dest_y != -1) {
         float remaining = dest_eta - dest_elapsed;
 
@@ -121,9 +145,10 @@ void Paddle::logic(float dt) {
     }
 }
 
-void Paddle::drawShadow() {
+void Paddle::drawShadow(float lag) {
     if(!gPaddleMode) return;
 
+    vec2f pos  = getDrawPos(lag);
     vec2f spos = vec2f(pos.x + 1.0f, pos.y + 1.0f);
 
     glColor4f(0.0, 0.0, 0.0, 0.7 * colour.w);
@@ -135,9 +160,11 @@ void Paddle::drawShadow() {
     glEnd();
 }
 
-void Paddle::draw() {
+void Paddle::draw(float lag) {
     if(!gPaddleMode) return;
 
+    vec2f pos = getDrawPos(lag);
+
     glColor4fv(colour);
     glBegin(GL_QUADS);
         glVertex2f(pos.x,pos.y-(height/2));
@@ -23,6 +23,7 @@
 #include "core/stringhash.h"
 
 #include "requestball.h"
+#include "arrivalqueue.h"
 
 #define PADDLE_NONE   0
 #define PADDLE_SINGLE 1
@@ -36,11 +37,19 @@ class Paddle {
 protected:
     vec2f pos;
 
+    //position at the previous step, to draw between the two
+    vec2f last_pos;
+
     RequestBall* target;
 
-    std::string token;
+    ArrivalQueue arrivals;
+
+    InternedString token;
     vec3f token_colour;
 
+    //requests in flight for this paddle's token
+    int ball_count;
+
     vec4f default_colour;
     vec4f proc_colour;
     vec4f colour;
@@ -55,7 +64,7 @@ protected:
     float dest_elapsed;
 
 public:
-    Paddle(vec2f pos, vec4f colour, std::string token);
+    Paddle(vec2f pos, vec4f colour, const InternedString& token);
     ~Paddle();
     void moveTo(int y, float eta, vec4f nextcol);
     bool moving();
@@ -64,12 +73,23 @@ public:
     void setTarget(RequestBall* target);
     RequestBall* getTarget();
 
+    ArrivalQueue& getArrivals();
+
+    void addBall();
+    void removeBall();
+    int getBallCount() const { return ball_count; }
+
+    const InternedString& getToken() const { return token; }
+
     void logic(float dt);
 
-    bool mouseOver(TextArea& textarea, vec2f& mouse);
+    //lag is the fraction of a step the drawing is behind the simulation
+    vec2f getDrawPos(float lag) const;
+
+    bool mouseOver(TextArea& textarea, vec2f& mouse, float lag);
 
-    void drawShadow();
-    void draw();
+    void drawShadow(float lag);
+    void draw(float lag);
 
     float getX();
     float getY();
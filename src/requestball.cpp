@@ -26,91 +26,123 @@ float gGlowIntensity  = 0.5;
 float gGlowMultiplier = 1.25;
 float gGlowDuration   = 0.15;
 
+//size of the ball for a response of this many bytes
+static float request_ball_size(LogEntry* le) {
+    float bytes = (float) le->response_size;
+    float size = log(bytes) + 1.0f;
+    if(size<5.0f) size = 5.0f;
+
+    return size;
+}
+
 RequestBall::RequestBall(LogEntry* le, FXFont* font, TextureResource* tex, const vec3f& colour, const vec2f& pos, const vec2f& dest, float speed) {
     this->le   = le;
     this->tex  = tex;
     this->font = font;
-    
+
+    path_handle = 0;
+    host_handle = 0;
+
+    index = 0;
+
+    paddle      = 0;
+    queue       = 0;
+    queue_index = 0;
+
     vec2f vel = dest - pos;
     vel.normalize();
 
-    int bytes = le->response_size;
-    float size = log((float)bytes) + 1.0f;
-    if(size<5.0f) size = 5.0f;
+    float size = request_ball_size(le);
 
     float eta = 5;
 
     ProjectedBall::init(pos, vel, colour, (int)dest.x, eta, size, speed);
 
-    this->speed = speed;
-
     start = pos;
     this->dest  = finish();
 
     if(!le->successful) dontBounce();
 
+    setSize(size);
+}
+
+void RequestBall::setSize(float size) {
+    ballstore.size[slot] = size;
+
     float halfsize = size * 0.5f;
     offset = vec2f(halfsize, halfsize);
+}
 
-    char buff[16];
-    snprintf(buff, 16, "%s", le->response_code.c_str());
-    response_code = std::string(buff);
+int RequestBall::merge(LogEntry* le, SummHandle path_handle, SummHandle host_handle) {
 
-    response_colour = responseColour();
-}
+    merged_handles.push_back(path_handle);
+    merged_handles.push_back(host_handle);
 
-RequestBall::~RequestBall() {
     delete le;
+
+    int appeared = ballstore.addWeight(slot);
+
+    int weight = getWeight();
+
+    //grows with the number of requests, up to three times the size
+    float size = request_ball_size(this->le) * std::min(3.0f, 1.0f + logf((float) weight) * 0.5f);
+
+    setSize(size);
+
+    return appeared;
 }
 
-vec3f RequestBall::responseColour() {
-    return le->response_colour;
+RequestBall::~RequestBall() {
+    delete le;
 }
 
 bool RequestBall::mouseOver(TextArea& textarea, vec2f& mouse) {
     //within 3 pixels
-    if((pos - mouse).length2()<36.0f) {
+    if((getDrawPos() - mouse).length2()<36.0f) {
 
         std::vector<std::string> content;
 
-        content.push_back( std::string( le->path ) );
+        content.push_back( le->path.str() );
         content.push_back( " " );
 
-        if(le->vhost.size()>0) content.push_back( std::string("Virtual-Host: ") + le->vhost );
+        int weight = getWeight();
 
-        content.push_back( std::string("Remote-Host:  ") + le->hostname );
+        if(weight > 1) {
+            char buff[32];
+            snprintf(buff, sizeof(buff), "%d", weight);
+            content.push_back( std::string("Requests:     ") + buff );
+        }
 
-        if(le->referrer.size()>0)   content.push_back( std::string("Referrer:     ") + le->referrer );
-        if(le->user_agent.size()>0) content.push_back( std::string("User-Agent:   ") + le->user_agent );
+        if(le->vhost.size()>0) content.push_back( std::string("Virtual-Host: ") + le->vhost.str() );
+
+        content.push_back( std::string("Remote-Host:  ") + le->hostname.str() );
+
+        if(le->referrer.size()>0)   content.push_back( std::string("Referrer:     ") + le->referrer.str() );
+        if(le->user_agent.size()>0) content.push_back( std::string("User-Agent:   ") + le->user_agent.str() );
 
         textarea.setText(content);
         textarea.setPos(mouse);
-        textarea.setColour(colour);
+        textarea.setColour(getColour());
         return true;
     }
 
     return false;
 }
 
-int RequestBall::logic(float dt) {
-    float old_x = pos.x;
-
-    ProjectedBall::logic(dt);
-
-    //returns 1 if just became visible (for score incrementing)
-    return (old_x<0.0f && pos.x>=0.0f);
-}
-
 void RequestBall::drawGlow() const {
     if(!hasBounced()) return;
 
     float prog = getProgress();
 
+    float size = getSize();
+
     float glow_radius = size * size * gGlowMultiplier;
 
     float alpha = std::min(1.0f, 1.0f-(prog/gGlowDuration));
 
-    vec3f glow_col = colour * gGlowIntensity * alpha;
+    vec3f glow_col = getColour() * gGlowIntensity * alpha;
+
+    vec2f pos = getDrawPos();
 
     glColor4f(glow_col.x, glow_col.y, glow_col.z, 1.0f);
 
@@ -136,8 +168,12 @@ void RequestBall::draw(float dt) const {
 
     if(gBounce || !has_bounced || no_bounce) {
 
-        vec2f offsetpos = pos - offset;
-        
+        vec2f offsetpos = getDrawPos() - offset;
+
+        float size = getSize();
+
+        vec3f colour = getColour();
+
         glColor4f(colour.x, colour.y, colour.z, 1.0f);
 
         glPushMatrix();
@@ -167,6 +203,8 @@ void RequestBall::drawResponseCode() const {
     if(!le->successful) drift *= -1.0f;
     vec2f msgpos = (vel * drift) + vec2f(dest.x-45.0f, dest.y);
 
+    const vec3f& response_colour = le->getResponseColour();
+
     glColor4f(response_colour.x, response_colour.y, response_colour.z, 1.0f - std::min(1.0f, prog * 2.0f) );
-    font->draw(msgpos.x, msgpos.y, response_code.c_str());
+    font->draw(msgpos.x, msgpos.y, le->response_code.str().c_str());
 }
@@ -23,6 +23,10 @@
 #include "logentry.h"
 #include "ball.h"
 #include "textarea.h"
+#include "summarizer.h"
+
+class ArrivalQueue;
+class Paddle;
 
 class RequestBall : public ProjectedBall {
 protected:
@@ -33,22 +37,45 @@ protected:
     vec2f offset;
     
     vec3f pagecolour;
-    vec3f responseColour();
 
     FXFont* font;
     TextureResource* tex;
 
-    std::string response_code;
-    vec3f       response_colour;
+    //summarizer handles of requests merged into this ball, path then host
+    std::vector<SummHandle> merged_handles;
+
+    void setSize(float size);
 public:
     LogEntry* le;
 
+    //path and hostname as added to the summarizers
+    SummHandle path_handle;
+    SummHandle host_handle;
+
+    //position in the list of balls in flight
+    size_t index;
+
+    //paddle for the request's token
+    Paddle* paddle;
+
+    //paddle queue the ball is waiting in, if any
+    ArrivalQueue* queue;
+    size_t queue_index;
+
     RequestBall(LogEntry* le, FXFont* font, TextureResource* tex, const vec3f& colour, const vec2f& pos, const vec2f& dest, float speed = 10.0f);
     ~RequestBall();
 
+    static void* operator new(size_t size)           { return slaballocator.allocate(size); }
+    static void  operator delete(void* ptr, size_t size) { slaballocator.release(ptr, size); }
+
     bool mouseOver(TextArea& textarea, vec2f& mouse);
 
-    int logic(float dt);
+    //add a similar request to this ball, which takes ownership of it.
+    //returns the number of requests moved onto the screen
+    int merge(LogEntry* le, SummHandle path_handle, SummHandle host_handle);
+
+    int getWeight() const { return ballstore.weight[slot]; }
+    const std::vector<SummHandle>& getMergedHandles() const { return merged_handles; }
 
     void drawGlow() const;
     void draw(float dt) const;
@@ -0,0 +1,169 @@
+/*
+    Copyright (C) 2012 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "slabpool.h"
+
+#include <new>
+
+SlabAllocator slaballocator;
+
+//SlabPool
+
+SlabPool::SlabPool(size_t object_size, size_t slab_objects) {
+
+    //free list pointer is stored in the object itself
+    if(object_size < sizeof(FreeObject)) object_size = sizeof(FreeObject);
+
+    this->object_size  = object_size;
+    this->slab_objects = slab_objects;
+
+    slab_next      = 0;
+    slab_remaining = 0;
+    free_list      = 0;
+
+    allocations = 0;
+    reused      = 0;
+    live        = 0;
+}
+
+SlabPool::~SlabPool() {
+    for(std::vector<char*>::iterator it = slabs.begin(); it != slabs.end(); it++) {
+        delete[] *it;
+    }
+}
+
+void* SlabPool::allocate() {
+
+    allocations++;
+    live++;
+
+    if(free_list != 0) {
+        FreeObject* object = free_list;
+        free_list = object->next;
+
+        reused++;
+
+        return object;
+    }
+
+    if(slab_remaining == 0) {
+        slab_next      = new char[object_size * slab_objects];
+        slab_remaining = slab_objects;
+
+        slabs.push_back(slab_next);
+    }
+
+    void* object = slab_next;
+
+    slab_next += object_size;
+    slab_remaining--;
+
+    return object;
+}
+
+void SlabPool::release(void* ptr) {
+    if(ptr == 0) return;
+
+    FreeObject* object = static_cast<FreeObject*>(ptr);
+
+    object->next = free_list;
+    free_list    = object;
+
+    live--;
+}
+
+//SlabAllocator
+
+SlabAllocator::SlabAllocator() {
+    for(int i=0;i<SLAB_ALLOCATOR_CLASSES;i++) {
+        pools[i] = 0;
+    }
+}
+
+SlabAllocator::~SlabAllocator() {
+    for(int i=0;i<SLAB_ALLOCATOR_CLASSES;i++) {
+        if(pools[i] != 0) delete pools[i];
+    }
+}
+
+void* SlabAllocator::allocate(size_t size) {
+
+    if(size > SLAB_ALLOCATOR_MAX_SIZE) return ::operator new(size);
+
+    if(size == 0) size = 1;
+
+    int size_class = (size - 1) / SLAB_ALLOCATOR_GRANULARITY;
+
+    if(pools[size_class] == 0) {
+        pools[size_class] = new SlabPool((size_class+1) * SLAB_ALLOCATOR_GRANULARITY);
+    }
+
+    return pools[size_class]->allocate();
+}
+
+void SlabAllocator::release(void* ptr, size_t size) {
+    if(ptr == 0) return;
+
+    if(size > SLAB_ALLOCATOR_MAX_SIZE) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    if(size == 0) size = 1;
+
+    pools[(size - 1) / SLAB_ALLOCATOR_GRANULARITY]->release(ptr);
+}
+
+unsigned int SlabAllocator::getAllocations() const {
+    unsigned int total = 0;
+
+    for(int i=0;i<SLAB_ALLOCATOR_CLASSES;i++) {
+        if(pools[i] != 0) total += pools[i]->getAllocations();
+    }
+
+    return total;
+}
+
+unsigned int SlabAllocator::getReused() const {
+    unsigned int total = 0;
+
+    for(int i=0;i<SLAB_ALLOCATOR_CLASSES;i++) {
+        if(pools[i] != 0) total += pools[i]->getReused();
+    }
+
+    return total;
+}
+
+unsigned int SlabAllocator::getLive() const {
+    unsigned int total = 0;
+
+    for(int i=0;i<SLAB_ALLOCATOR_CLASSES;i++) {
+        if(pools[i] != 0) total += pools[i]->getLive();
+    }
+
+    return total;
+}
+
+size_t SlabAllocator::getReserved() const {
+    size_t total = 0;
+
+    for(int i=0;i<SLAB_ALLOCATOR_CLASSES;i++) {
+        if(pools[i] != 0) total += pools[i]->getReserved();
+    }
+
+    return total;
+}
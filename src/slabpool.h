@@ -0,0 +1,89 @@
+/*
+    Copyright (C) 2012 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SLAB_POOL_H
+#define SLAB_POOL_H
+
+#include <stdlib.h>
+#include <vector>
+
+#define SLAB_POOL_OBJECTS 256
+
+#define SLAB_ALLOCATOR_GRANULARITY 16
+#define SLAB_ALLOCATOR_MAX_SIZE    1024
+#define SLAB_ALLOCATOR_CLASSES     (SLAB_ALLOCATOR_MAX_SIZE / SLAB_ALLOCATOR_GRANULARITY)
+
+//fixed size objects carved out of large slabs. released objects go on
+//a free list to be handed out again rather than back to the heap.
+//not thread safe.
+
+class SlabPool {
+
+    struct FreeObject {
+        FreeObject* next;
+    };
+
+    size_t object_size;
+    size_t slab_objects;
+
+    std::vector<char*> slabs;
+
+    char*  slab_next;
+    size_t slab_remaining;
+
+    FreeObject* free_list;
+
+    unsigned int allocations;
+    unsigned int reused;
+    unsigned int live;
+public:
+    SlabPool(size_t object_size, size_t slab_objects = SLAB_POOL_OBJECTS);
+    ~SlabPool();
+
+    void* allocate();
+    void  release(void* ptr);
+
+    size_t getObjectSize() const { return object_size; }
+
+    unsigned int getAllocations() const { return allocations; }
+    unsigned int getReused() const      { return reused; }
+    unsigned int getLive() const        { return live; }
+
+    size_t getReserved() const { return slabs.size() * slab_objects * object_size; }
+};
+
+//pools for each size class, rounded up to SLAB_ALLOCATOR_GRANULARITY bytes
+
+class SlabAllocator {
+    SlabPool* pools[SLAB_ALLOCATOR_CLASSES];
+public:
+    SlabAllocator();
+    ~SlabAllocator();
+
+    void* allocate(size_t size);
+    void  release(void* ptr, size_t size);
+
+    unsigned int getAllocations() const;
+    unsigned int getReused() const;
+    unsigned int getLive() const;
+
+    size_t getReserved() const;
+};
+
+extern SlabAllocator slaballocator;
+
+#endif
@@ -0,0 +1,123 @@
+/*
+    Copyright (C) 2012 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stringtable.h"
+
+StringTable stringtable;
+
+StringTable::StringTable() {
+    count = 0;
+
+    //reserve id 0 for the empty string
+    Entry empty;
+    empty.hash = stringHashFNV(empty.str);
+    empty.refs = 1;
+    empty.next = STRING_TABLE_NONE;
+
+    entries.push_back(empty);
+
+    buckets.resize(1024, STRING_TABLE_NONE);
+}
+
+void StringTable::rehash(size_t no_buckets) {
+
+    buckets.clear();
+    buckets.resize(no_buckets, STRING_TABLE_NONE);
+
+    unsigned int mask = no_buckets - 1;
+
+    for(unsigned int id=1;id<entries.size();id++) {
+        Entry& entry = entries[id];
+
+        if(entry.refs == 0) continue;
+
+        unsigned int b = entry.hash & mask;
+
+        entry.next = buckets[b];
+        buckets[b] = id;
+    }
+}
+
+unsigned int StringTable::intern(const std::string& str) {
+
+    if(str.empty()) return 0;
+
+    unsigned int hash = stringHashFNV(str);
+    unsigned int b    = hash & (buckets.size()-1);
+
+    for(unsigned int id = buckets[b]; id != STRING_TABLE_NONE; id = entries[id].next) {
+        Entry& entry = entries[id];
+
+        if(entry.hash == hash && entry.str == str) {
+            entry.refs++;
+            return id;
+        }
+    }
+
+    unsigned int id;
+
+    if(!free_ids.empty()) {
+        id = free_ids.back();
+        free_ids.pop_back();
+    } else {
+        id = entries.size();
+        entries.push_back(Entry());
+    }
+
+    Entry& entry = entries[id];
+    entry.str  = str;
+    entry.hash = hash;
+    entry.refs = 1;
+    entry.next = buckets[b];
+
+    buckets[b] = id;
+
+    if(++count > buckets.size()) {
+        rehash(buckets.size() * 2);
+    }
+
+    return id;
+}
+
+void StringTable::acquire(unsigned int id) {
+    if(id == 0) return;
+
+    entries[id].refs++;
+}
+
+void StringTable::release(unsigned int id) {
+    if(id == 0) return;
+
+    Entry& entry = entries[id];
+
+    if(--entry.refs > 0) return;
+
+    //unlink from bucket
+    unsigned int* link = &buckets[entry.hash & (buckets.size()-1)];
+
+    while(*link != id) {
+        link = &entries[*link].next;
+    }
+
+    *link = entry.next;
+
+    std::string().swap(entry.str);
+    entry.next = STRING_TABLE_NONE;
+
+    free_ids.push_back(id);
+    count--;
+}
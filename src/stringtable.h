@@ -0,0 +1,102 @@
+/*
+    Copyright (C) 2012 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef STRING_TABLE_H
+#define STRING_TABLE_H
+
+#include <string>
+#include <vector>
+#include <deque>
+
+#include "core/stringhash.h"
+
+#define STRING_TABLE_NONE 0xffffffff
+
+//reference counted table of distinct strings, each identified by a 32 bit id
+//that stays the same while the string is in use. id 0 is the empty string.
+
+class StringTable {
+
+    struct Entry {
+        std::string str;
+        unsigned int hash;
+        unsigned int refs;
+        unsigned int next;
+    };
+
+    //deque so references returned by get() survive new strings being added
+    std::deque<Entry> entries;
+
+    std::vector<unsigned int> buckets;
+    std::vector<unsigned int> free_ids;
+
+    size_t count;
+
+    void rehash(size_t no_buckets);
+public:
+    StringTable();
+
+    unsigned int intern(const std::string& str);
+
+    void acquire(unsigned int id);
+    void release(unsigned int id);
+
+    const std::string& get(unsigned int id) const { return entries[id].str; }
+
+    size_t size() const { return count; }
+};
+
+extern StringTable stringtable;
+
+//string held as an id in the string table, compared by id
+
+class InternedString {
+    unsigned int id;
+public:
+    InternedString() : id(0) {}
+    InternedString(const std::string& str) : id(stringtable.intern(str)) {}
+    InternedString(const InternedString& other) : id(other.id) { stringtable.acquire(id); }
+    ~InternedString() { stringtable.release(id); }
+
+    InternedString& operator=(const InternedString& other) {
+        stringtable.acquire(other.id);
+        stringtable.release(id);
+        id = other.id;
+        return *this;
+    }
+
+    InternedString& operator=(const std::string& str) {
+        unsigned int new_id = stringtable.intern(str);
+        stringtable.release(id);
+        id = new_id;
+        return *this;
+    }
+
+    unsigned int getId() const { return id; }
+
+    const std::string& str() const { return stringtable.get(id); }
+    operator const std::string&() const { return stringtable.get(id); }
+
+    size_t size() const { return str().size(); }
+    bool empty() const  { return id == 0; }
+
+    bool operator==(const InternedString& other) const { return id == other.id; }
+    bool operator!=(const InternedString& other) const { return id != other.id; }
+    bool operator<(const InternedString& other) const  { return id < other.id; }
+};
+
+#endif
@@ -17,6 +17,10 @@
 
 #include "summarizer.h"
 
+#include <new>
+#include <string.h>
+#include <algorithm>
+
 /*
 
 Method:
@@ -37,84 +41,369 @@ SummUnit::SummUnit() {
     this->refs=0;
     this->truncated=false;
     this->exceptions=false;
+    this->expansions=0;
 }
 
 SummUnit::SummUnit(SummNode* source, bool truncated, bool exceptions) {
-    this->source    = source;
     this->words     = source->words;
     this->refs      = source->refs;
     this->truncated = truncated;
     this->exceptions= exceptions;
+    this->expansions= exceptions ? source->countExpansions() : 1;
 
-    if(source->parent!=0) prependChar(source->c);
+    if(source->parent!=0) prepend(source->label);
 }
 
-void SummUnit::buildSummary() {
-    expanded.clear();
-    source->expand(str, expanded, exceptions);
+void SummUnit::prepend(const std::string& prefix) {
+    str.insert(0, prefix);
 }
 
-void SummUnit::prependChar(char c) {
-    str.insert(0,1,c);
+void SummUnit::swap(SummUnit& other) {
+    std::swap(words,      other.words);
+    std::swap(refs,       other.refs);
+    std::swap(truncated,  other.truncated);
+    std::swap(exceptions, other.exceptions);
+    std::swap(expansions, other.expansions);
+
+    str.swap(other.str);
 }
 
 //SummNode
 
 const char* summ_wildcard = "*";
 
+//address keys are shown as the address or CIDR block they cover
+std::string summ_display_string(const std::string& str) {
+
+    if(str.empty() || (str[0] != SUMM_KEY_IPV4 && str[0] != SUMM_KEY_IPV6)) return str;
+
+    HostAddress address;
+    address.type = (str[0] == SUMM_KEY_IPV4) ? HOST_ADDRESS_IPV4 : HOST_ADDRESS_IPV6;
+
+    size_t no_bytes = std::min(str.size()-1, (size_t) (address.bits() / 8));
+
+    memcpy(address.bytes, str.data()+1, no_bytes);
+
+    return address.cidrString(no_bytes * 8);
+}
+
 SummNode::SummNode() {
-    c = '*';
     words=0;
+    refs=0;
+    ends=0;
+    leaves=0;
+    created_leaf=false;
+    changed=true;
+    summary_words=0;
     parent=0;
+    child_index=0;
 }
 
+//leaf holding the rest of the string
 SummNode::SummNode(const std::string& str, size_t offset, SummNode* parent) {
-    c = str[offset];
-    words=0;
-    refs=0;
+    label = str.substr(offset);
+    words=1;
+    refs=1;
+    ends=1;
+    leaves=1;
+    created_leaf=true;
+    changed=true;
+    summary_words=0;
     this->parent=parent;
+    child_index=0;
+}
+
+SummNode::~SummNode() {
+    if(child_index!=0) delete[] child_index;
+}
+
+SummNode* SummNode::getChild(char c) const {
+
+    if(child_index!=0) return child_index[(unsigned char) c];
+
+    size_t no_children = children.size();
+
+    for(size_t i=0;i<no_children;i++) {
+        if(children[i]->label[0] == c) return children[i];
+    }
+
+    return 0;
+}
+
+void SummNode::addChild(SummNode* child) {
+    children.push_back(child);
+
+    if(child_index!=0) {
+        child_index[(unsigned char) child->label[0]] = child;
+        return;
+    }
+
+    if(children.size() > SUMM_NODE_INDEX_THRESHOLD) {
+        child_index = new SummNode*[256];
+
+        for(int i=0;i<256;i++) child_index[i] = 0;
+
+        for(size_t i=0;i<children.size();i++) {
+            child_index[(unsigned char) children[i]->label[0]] = children[i];
+        }
+    }
+}
+
+void SummNode::removeChild(SummNode* child) {
+
+    for(std::vector<SummNode*>::iterator it = children.begin(); it != children.end(); it++) {
+        if(*it == child) {
+            children.erase(it);
+            break;
+        }
+    }
+
+    if(child_index!=0) {
+        child_index[(unsigned char) child->label[0]] = 0;
+
+        if(children.size() <= SUMM_NODE_INDEX_THRESHOLD/2) {
+            delete[] child_index;
+            child_index = 0;
+        }
+    }
+}
+
+//replacement starts with the same character, so keeps the same position
+void SummNode::replaceChild(SummNode* child, SummNode* replacement) {
+
+    size_t no_children = children.size();
+
+    for(size_t i=0;i<no_children;i++) {
+        if(children[i] == child) {
+            children[i] = replacement;
+            break;
+        }
+    }
+
+    if(child_index!=0) child_index[(unsigned char) replacement->label[0]] = replacement;
+}
+
+//insert a new parent holding the first 'length' characters of the label.
+//this node keeps the rest, so nodes strings end at stay the same.
+SummNode* SummNode::split(SlabPool& pool, size_t length) {
+
+    SummNode* upper = new (pool.allocate()) SummNode();
+
+    upper->label  = label.substr(0, length);
+    upper->words  = words;
+    upper->refs   = refs;
+    upper->leaves = leaves;
+    upper->parent = parent;
+
+    parent->replaceChild(this, upper);
+    upper->addChild(this);
 
-    //if leaf
-    if(!addWord(str, ++offset)) {
-         words=1;
+    label.erase(0, length);
+    parent = upper;
+    changed = true;
+
+    //words counts the strings continuing past the first character,
+    //plus one if it was created as the end of a string
+    if(label.size() == 1) {
+        words = refs - ends + (created_leaf ? 1 : 0);
+    } else {
+        words = refs;
     }
+
+    return upper;
 }
 
-bool SummNode::removeWord(const std::string& str, size_t offset) {
+//absorb this node into its only child. not done for nodes created as the
+//end of a string, as their word count would be lost
+void SummNode::merge(SlabPool& pool) {
+
+    if(created_leaf) return;
+
 
-    refs--;
+    SummNode* child = children[0];
 
-    size_t str_size = str.size() - offset;
-    
-    if(!str_size) return false;
+    child->label.insert(0, label);
+    child->words   = words;
+    child->parent  = parent;
+    child->changed = true;
 
-    words--;
+    parent->replaceChild(this, child);
 
+    children.clear();
+
+    this->~SummNode();
+    pool.release(this);
+}
+
+void SummNode::clear(SlabPool& pool) {
     size_t no_children = children.size();
-    
-    bool removed = false;
-    
+
     for(size_t i=0;i<no_children;i++) {
-        if(children[i]->c == str[offset]) {
-            removed = children[i]->removeWord(str,++offset);
+        children[i]->destroy(pool);
+    }
+
+    children.clear();
+
+    if(child_index!=0) {
+        delete[] child_index;
+        child_index = 0;
+    }
+}
+
+void SummNode::destroy(SlabPool& pool) {
+    clear(pool);
+
+    this->~SummNode();
+    pool.release(this);
+}
+
+//apply a change in the number of leaves to this node and its ancestors
+void SummNode::addLeaves(int delta) {
+    for(SummNode* node = this; node != 0; node = node->parent) {
+        node->leaves += delta;
+    }
+}
+
+//size of the expansion of a truncated unit, without summarizing the
+//children left out of the summary
+int SummNode::countExpansions() const {
+    int count = 0;
+
+    size_t no_child = children.size();
+
+    for(size_t i=0;i<no_child;i++) {
+        if(!exception[i]) continue;
+
+        count += std::min(children[i]->leaves, 100);
+    }
+
+    return count;
+}
+
+//remove count copies of a string at once
+void SummNode::removeWord(SlabPool& pool, const std::string& str, size_t offset, int count) {
+
+    refs -= count;
+    changed = true;
+
+    if(offset == str.size()) {
+        ends -= count;
+        return;
+    }
+
+    words -= count;
+
+    SummNode* node = this;
+
+    for(;;) {
+        SummNode* child = node->getChild(str[offset]);
+
+        size_t remaining = str.size() - offset;
+
+        if(child == 0 || remaining < child->label.size()
+           || str.compare(offset, child->label.size(), child->label) != 0) return;
+
+        child->refs -= count;
+        if(remaining > 1) child->words -= count;
+        child->changed = true;
+
+        offset += child->label.size();
+
+        if(offset == str.size()) child->ends -= count;
 
-            if(children[i]->refs == 0) {
-                std::vector<SummNode*>::iterator it = children.begin()+i;
-                delete *it;
-                children.erase(it);
+        if(child->refs == 0) {
+            node->removeChild(child);
+
+            //parent becomes a leaf if this was its last child
+            node->addLeaves((node->children.empty() ? 1 : 0) - child->leaves);
+
+            child->destroy(pool);
+
+            //parent may now be a link with nothing ending at it
+            if(node->parent != 0 && node->ends == 0 && node->children.size() == 1) {
+                node->merge(pool);
             }
 
-            break;
+            return;
+        }
+
+        if(offset == str.size()) {
+            if(child->ends == 0 && child->children.size() == 1) {
+                child->merge(pool);
+            }
+
+            return;
+        }
+
+        node = child;
+    }
+}
+
+//remove one of the strings ending at this node, without walking down
+//from the root to find it
+void SummNode::removeWord(SlabPool& pool) {
+
+    ends--;
+
+    //highest node with no strings left through it
+    SummNode* empty = 0;
+
+    for(SummNode* node = this; node != 0; node = node->parent) {
+        node->refs--;
+        node->changed = true;
+
+        //words only counts strings continuing past the first character
+        if(node != this || label.size() > 1) node->words--;
+
+        if(node->refs == 0 && node->parent != 0) empty = node;
+    }
+
+    if(empty != 0) {
+        SummNode* node = empty->parent;
+
+        node->removeChild(empty);
+
+        //parent becomes a leaf if this was its last child
+        node->addLeaves((node->children.empty() ? 1 : 0) - empty->leaves);
+
+        empty->destroy(pool);
+
+        //parent may now be a link with nothing ending at it
+        if(node->parent != 0 && node->ends == 0 && node->children.size() == 1) {
+            node->merge(pool);
         }
+
+        return;
     }
 
-    return removed;
+    if(parent != 0 && ends == 0 && children.size() == 1) {
+        merge(pool);
+    }
+}
+
+//node a string ends at, or 0 if it ends part way through a label
+SummNode* SummNode::findWord(const std::string& str) {
+
+    SummNode* node = this;
+    size_t offset  = 0;
+
+    while(offset < str.size()) {
+        SummNode* child = node->getChild(str[offset]);
+
+        if(child == 0 || str.size() - offset < child->label.size()
+           || str.compare(offset, child->label.size(), child->label) != 0) return 0;
+
+        offset += child->label.size();
+        node = child;
+    }
+
+    return node;
 }
 
 void SummNode::debug(int indent) {
     for(int i=0;i<indent;i++)
         debugLog(" ");
-    debugLog("node c=%c refs=%d words=%d\n", c, refs, words);
+    debugLog("node label=%s refs=%d words=%d ends=%d\n", label.c_str(), refs, words, ends);
     indent++;
 
     for(size_t i=0;i<children.size();i++) {
@@ -123,32 +412,64 @@ void SummNode::debug(int indent) {
     }
 }
 
-bool SummNode::addWord(const std::string& str, size_t offset) {
-    
+SummNode* SummNode::addWord(SlabPool& pool, const std::string& str, size_t offset) {
+
     refs++;
+    changed = true;
 
-    size_t str_size = str.size() - offset;
+    if(offset == str.size()) {
+        ends++;
+        return this;
+    }
 
-    if(!str_size) return false;
-    
     words++;
-        
-    size_t no_children = children.size();
 
-    for(size_t i=0;i<no_children;i++) {
-        if(children[i]->c == str[offset]) {
-            return children[i]->addWord(str, ++offset);
+    SummNode* node = this;
+
+    for(;;) {
+        SummNode* child = node->getChild(str[offset]);
+
+        if(child == 0) {
+            //replaces the parent as a leaf unless it already had children
+            if(!node->children.empty()) node->addLeaves(1);
+
+            SummNode* leaf = new (pool.allocate()) SummNode(str, offset, node);
+
+            node->addChild(leaf);
+            return leaf;
+        }
+
+        size_t remaining = str.size() - offset;
+
+        size_t common = 1;
+
+        while(common < child->label.size() && common < remaining
+              && child->label[common] == str[offset+common]) {
+            common++;
+        }
+
+        if(common < child->label.size()) {
+            child = child->split(pool, common);
         }
-    }
 
-    children.push_back(new SummNode(str, offset, this));
+        child->refs++;
+        if(remaining > 1) child->words++;
+        child->changed = true;
 
-    return true;
+        offset += common;
+
+        if(offset == str.size()) {
+            child->ends++;
+            return child;
+        }
+
+        node = child;
+    }
 }
 
 std::string format_node(std::string str, int refs) {
     char buff[256];
-    snprintf(buff, 256, "%03d %s", refs, str.c_str());
+    snprintf(buff, 256, "%03d %s", refs, summ_display_string(str).c_str());
 
     return std::string(buff);
 }
@@ -165,7 +486,8 @@ void SummNode::expand(std::string prefix, std::vector<std::string>& vec, bool ex
     std::vector<SummUnit>::iterator it;
 
     for(size_t i=0;i<no_child;i++) {
-        if(exceptions && !exception[i]) continue;
+        //exceptions are from the last time this node was summarized
+        if(exceptions && (i >= exception.size() || !exception[i])) continue;
 
         std::vector<SummUnit> strvec;
         children[i]->summarize(strvec, 100);
@@ -176,8 +498,37 @@ void SummNode::expand(std::string prefix, std::vector<std::string>& vec, bool ex
     }
 }
 
+//only nodes on the path of an added or removed string, or given a
+//different number of words than last time, are summarized again
 int SummNode::summarize(std::vector<SummUnit>& strvec, int no_words) {
 
+    //a subtree that fits is listed in full, which costs about the same as
+    //copying a cached list, so only keep the result where it saves work
+    if(parent != 0 && (words < SUMM_NODE_CACHE_THRESHOLD || words <= no_words)) {
+
+        if(!summary.empty()) {
+            std::vector<SummUnit>().swap(summary);
+            summary_words = 0;
+        }
+
+        return summarizeNode(strvec, no_words);
+    }
+
+    if(changed || summary_words != no_words) {
+        summary.clear();
+        summarizeNode(summary, no_words);
+
+        summary_words = no_words;
+        changed       = false;
+    }
+
+    strvec.insert(strvec.end(), summary.begin(), summary.end());
+
+    return summary.size();
+}
+
+int SummNode::summarizeNode(std::vector<SummUnit>& strvec, int no_words) {
+
     // if no children, just append this node
     if(children.size()==0 && parent!=0) {
         strvec.push_back(SummUnit(this));
@@ -248,7 +599,7 @@ int SummNode::summarize(std::vector<SummUnit>& strvec, int no_words) {
         size_t newsize = (size_t) (count + currsize);
 
         for(size_t j=currsize;j<newsize;j++) {
-            if(parent!=0) strvec[j].prependChar(c);
+            if(parent!=0) strvec[j].prepend(label);
         }
     }
 
@@ -262,7 +613,7 @@ int SummNode::summarize(std::vector<SummUnit>& strvec, int no_words) {
             total_count += count;
 
             for(size_t j=currsize;j<newsize;j++) {
-                if(parent!=0) strvec[j].prependChar(c);
+                if(parent!=0) strvec[j].prepend(label);
             }
 
             return total_count;
@@ -277,41 +628,75 @@ int SummNode::summarize(std::vector<SummUnit>& strvec, int no_words) {
 
 
 // SummItem
-void SummItem::updateUnit(SummUnit& unit) {
 
-    this->unit = unit;
+void SummItem::updateUnit(const SummUnit& unit) {
+
+    this->unit.words      = unit.words;
+    this->unit.refs       = unit.refs;
+    this->unit.truncated  = unit.truncated;
+    this->unit.exceptions = unit.exceptions;
+    this->unit.expansions = unit.expansions;
+
+    if(this->unit.str != unit.str) this->unit.str = unit.str;
 
     vec3f col = icol!=0 ? *icol : colourHash(unit.str);
     this->colour = vec4f(col, 1.0f);
 
+    std::string label = summ_display_string(unit.str);
+
     char buff[1024];
 
     if(unit.truncated) {
         if(showcount) {
-            snprintf(buff, 1024, "%03d %s (%d)", unit.refs, unit.str.c_str(), (int) unit.expanded.size());
+            snprintf(buff, 1024, "%03d %s (%d)", unit.refs, label.c_str(), unit.expansions);
         } else {
-            snprintf(buff, 1024, "%s (%d)", unit.str.c_str(), (int) unit.expanded.size());
+            snprintf(buff, 1024, "%s (%d)", label.c_str(), unit.expansions);
         }
     } else {
         if(showcount) {
-        snprintf(buff, 1024, "%03d %s", unit.refs, unit.str.c_str());
+        snprintf(buff, 1024, "%03d %s", unit.refs, label.c_str());
         } else {
-        snprintf(buff, 1024, "%s", unit.str.c_str());
+        snprintf(buff, 1024, "%s", label.c_str());
         }
     }
 
     this->displaystr = std::string(buff);
-    this->width = font.getWidth(displaystr);
+    this->width = font->getWidth(displaystr);
 
 }
 
-SummItem::SummItem(SummUnit unit, vec2f pos, vec2f dest, float target_x, vec3f* icol, FXFont font, bool showcount) {
+void SummItem::swap(SummItem& other) {
+    std::swap(dest,      other.dest);
+    std::swap(oldpos,    other.oldpos);
+    std::swap(moving,    other.moving);
+    std::swap(elapsed,   other.elapsed);
+    std::swap(eta,       other.eta);
+    std::swap(target_x,  other.target_x);
+    std::swap(icol,      other.icol);
+    std::swap(showcount, other.showcount);
+    std::swap(font,      other.font);
+    std::swap(departing, other.departing);
+    std::swap(destroy,   other.destroy);
+    std::swap(width,     other.width);
+    std::swap(colour,    other.colour);
+    std::swap(pos,       other.pos);
+
+    std::swap(expanded_batch, other.expanded_batch);
+
+    displaystr.swap(other.displaystr);
+    expanded.swap(other.expanded);
+    unit.swap(other.unit);
+}
+
+SummItem::SummItem(const SummUnit& unit, vec2f pos, vec2f dest, float target_x, vec3f* icol, FXFont* font, bool showcount) {
     this->pos  = pos;
     this->target_x = target_x;
     this->icol = icol;
     this->font = font;
     this->showcount=showcount;
 
+    expanded_batch = 0;
+
     updateUnit(unit);
 
     destroy=false;
@@ -364,13 +749,160 @@ void SummItem::logic(float dt) {
 
 void SummItem::draw(float alpha) {
     glColor4f(colour.x, colour.y, colour.z, colour.w * alpha);
-    font.draw((int)pos.x, (int)pos.y, displaystr.c_str());
+    font->draw((int)pos.x, (int)pos.y, displaystr.c_str());
 }
 
 // Summarizer
 
+//replace the value without locking. the full barrier makes sure a snapshot
+//is complete before the other thread can take it. (SDL 1.2 has no atomics)
+static size_t summ_exchange(volatile size_t* ptr, size_t value) {
+    size_t old = __sync_fetch_and_add(ptr, 0);
+    size_t seen;
+
+    while((seen = __sync_val_compare_and_swap(ptr, old, value)) != old) {
+        old = seen;
+    }
+
+    return old;
+}
+
+static size_t summ_load(volatile size_t* ptr) {
+    return __sync_fetch_and_add(ptr, 0);
+}
+
+static SummSnapshot* summ_snapshot(size_t address) {
+    return (SummSnapshot*) (address & ~(size_t) SUMM_SNAPSHOT_FRESH);
+}
+
+// SummWorker
+
+SummWorker summ_worker;
+
+extern "C" {
+static int summarizer_thread(void *arg) {
+    SummWorker *worker = static_cast<SummWorker *>(arg);
+
+    worker->run();
+
+    return 0;
+}
+};
+
+SummWorker::SummWorker() {
+    thread   = 0;
+    mutex    = 0;
+    cond     = 0;
+    idle     = 0;
+    busy     = 0;
+    next     = 0;
+    finished = false;
+}
+
+//the thread is started with the first summarizer
+void SummWorker::add(Summarizer* summarizer) {
+
+    if(thread == 0) {
+        mutex    = SDL_CreateMutex();
+        cond     = SDL_CreateCond();
+        idle     = SDL_CreateCond();
+        finished = false;
+        thread   = SDL_CreateThread( summarizer_thread, this );
+    }
+
+    SDL_mutexP(mutex);
+
+    summarizers.push_back(summarizer);
+
+    SDL_mutexV(mutex);
+}
+
+//waits for any work on the summarizer to finish, and stops the
+//thread with the last one
+void SummWorker::remove(Summarizer* summarizer) {
+
+    SDL_mutexP(mutex);
+
+    summarizers.erase(std::find(summarizers.begin(), summarizers.end(), summarizer));
+
+    while(busy == summarizer) {
+        SDL_CondWait(idle, mutex);
+    }
+
+    bool last = summarizers.empty();
+
+    if(last) {
+        finished = true;
+        SDL_CondSignal(cond);
+    }
+
+    SDL_mutexV(mutex);
+
+    if(!last) return;
+
+    SDL_WaitThread(thread, 0);
+
+    SDL_DestroyCond(idle);
+    SDL_DestroyCond(cond);
+    SDL_DestroyMutex(mutex);
+
+    thread = 0;
+    mutex  = 0;
+    cond   = 0;
+    idle   = 0;
+}
+
+//next summarizer with work, taking turns
+Summarizer* SummWorker::findWork() {
+
+    size_t no_summarizers = summarizers.size();
+
+    for(size_t i=0;i<no_summarizers;i++) {
+        size_t j = (next + i) % no_summarizers;
+
+        if(summarizers[j]->hasWork()) {
+            next = j + 1;
+            return summarizers[j];
+        }
+    }
+
+    return 0;
+}
+
+void SummWorker::run() {
+
+    SDL_mutexP(mutex);
+
+    for (;;) {
+        Summarizer* summarizer = 0;
+
+        while(!finished && (summarizer = findWork()) == 0) {
+            SDL_CondWait(cond, mutex);
+        }
+
+        if(finished) break;
+
+        busy = summarizer;
+        summarizer->takeWork();
+
+        SDL_mutexV(mutex);
+
+        summarizer->doWork();
+
+        SDL_mutexP(mutex);
+
+        summarizer->finishWork();
+
+        busy = 0;
+        SDL_CondBroadcast(idle);
+    }
+
+    SDL_mutexV(mutex);
+}
+
+
 Summarizer::Summarizer(FXFont font, float x, float top_gap, float bottom_gap, float refresh_delay, std::string matchstr, std::string title)
-    : matchre(matchstr)
+    : node_pool(sizeof(SummNode)), matchre(matchstr)
  {
     this->pos_x      = x;
     this->top_gap    = top_gap;
@@ -383,21 +915,44 @@ Summarizer::Summarizer(FXFont font, float x, float top_gap, float bottom_gap, fl
 
     this->item_colour=0;
     this->showcount=false;
+    this->addresses=false;
 
-    changed = false;
+    strings_changed = false;
 
     font_gap    = font.getHeight() + 4;
     max_strings = (int) ((display.height-top_gap-bottom_gap)/font_gap);
     incrementf   =0;
-    root = SummNode();
 
     mouseover=false;
 
+    //room for a full set of items arriving while the last set departs
+    items.reserve(max_strings * 2);
+
     right = (pos_x > (display.width/2)) ? true : false;
 
     if(this->title.size()) {
         this->top_gap+= font_gap;
     }
+
+    front = new SummSnapshot();
+    back  = new SummSnapshot();
+    ready = (size_t) new SummSnapshot();
+
+    submitted = 0;
+
+    wanted_expansion.exceptions = false;
+    wanted_expansion.batch      = 0;
+    expansion_wanted            = false;
+
+    ready_expansion.exceptions = false;
+    ready_expansion.batch      = 0;
+
+    expanding = false;
+    applied   = 0;
+
+    next_handle = 1;
+
+    summ_worker.add(this);
 }
 
 void Summarizer::mouseOut() {
@@ -413,17 +968,49 @@ bool Summarizer::mouseOver(TextArea& textarea, vec2f mouse) {
 
     float y = mouse.y;
 
-    std::list<SummItem>::iterator it;
-    for(it=items.begin();it!=items.end();it++) {
-        SummItem* si = &(*it);
+    size_t noitems = items.size();
+
+    for(size_t i=0;i<noitems;i++) {
+        SummItem* si = &items[i];
         if(si->departing) continue;
 
         if(si->pos.y<=y && (si->pos.y+font.getHeight()+4) > y) {
             if(mouse.x< si->pos.x || mouse.x > si->pos.x + si->width) continue;
 
-            std::vector<std::string> content;
+            const SummUnit& unit = si->unit;
+
+            //the trie belongs to the worker thread, so ask it for the lines
+            //and show the last ones it built until they arrive
+            SDL_mutexP(summ_worker.mutex);
+
+            if(ready_expansion.batch > si->expanded_batch && ready_expansion.str == unit.str
+               && ready_expansion.exceptions == unit.exceptions) {
+                si->expanded       = ready_expansion.lines;
+                si->expanded_batch = ready_expansion.batch;
+            }
+
+            bool asked = wanted_expansion.batch == front->batch && wanted_expansion.str == unit.str
+                         && wanted_expansion.exceptions == unit.exceptions;
+
+            if(si->expanded_batch < front->batch && !asked) {
+                wanted_expansion.str        = unit.str;
+                wanted_expansion.exceptions = unit.exceptions;
+                wanted_expansion.batch      = front->batch;
+                expansion_wanted = true;
+
+                SDL_CondSignal(summ_worker.cond);
+            }
+
+            SDL_mutexV(summ_worker.mutex);
+
+            if(si->expanded.empty()) {
+                std::vector<std::string> content;
+                content.push_back(si->displaystr);
 
-            textarea.setText(si->unit.expanded);
+                textarea.setText(content);
+            } else {
+                textarea.setText(si->expanded);
+            }
             textarea.setColour(si->colour.truncate());
             textarea.setPos(mouse);
             mouseover=true;
@@ -447,26 +1034,146 @@ vec3f Summarizer::getColour() {
 }
 
 Summarizer::~Summarizer() {
+
+    summ_worker.remove(this);
+
+    root.clear(node_pool);
+
+    delete front;
+    delete back;
+    delete summ_snapshot(ready);
+
     if(item_colour!=0) delete item_colour;
 }
 
-bool Summarizer::supportedString(std::string& str) {
+bool Summarizer::supportedString(const std::string& str) {
     return matchre.match(str);
 }
 
-void Summarizer::summarize() {
-    if(!changed) return;
+unsigned int Summarizer::summarize() {
+    if(queued_ops.empty()) return submitted;
 
-    changed = false;
-    
-    strings.clear();
-    root.summarize(strings,max_strings);
+    SDL_mutexP(summ_worker.mutex);
 
-    size_t nostrs = strings.size();
+    if(pending_ops.empty()) {
+        pending_ops.swap(queued_ops);
+    } else {
+        pending_ops.insert(pending_ops.end(), queued_ops.begin(), queued_ops.end());
+        queued_ops.clear();
+    }
 
-    for(size_t i=0;i<nostrs;i++) {
-        strings[i].buildSummary();
+    submitted++;
+
+    SDL_CondSignal(summ_worker.cond);
+    SDL_mutexV(summ_worker.mutex);
+
+    return submitted;
+}
+
+bool Summarizer::hasWork() const {
+    return !pending_ops.empty() || expansion_wanted;
+}
+
+void Summarizer::takeWork() {
+
+    if(!pending_ops.empty()) {
+        applying_ops.swap(pending_ops);
+        applied = submitted;
+    }
+
+    expanding = expansion_wanted;
+
+    if(expanding) {
+        building_expansion.str        = wanted_expansion.str;
+        building_expansion.exceptions = wanted_expansion.exceptions;
+        expansion_wanted = false;
     }
+}
+
+//apply changes and summarize the trie, publishing the summary by swapping
+//it with the last one published. the trie is only used by the worker, so
+//tooltips are built here too when asked for.
+void Summarizer::doWork() {
+
+    if(!applying_ops.empty()) {
+        applyOps();
+
+        back->strings.clear();
+        root.summarize(back->strings, max_strings);
+
+        back->batch = applied;
+        back->buildIndex();
+
+        //a snapshot not taken yet is replaced, and built over next time
+        back = summ_snapshot(summ_exchange(&ready, (size_t) back | SUMM_SNAPSHOT_FRESH));
+    }
+
+    //the node is found again by its string, as the trie may have
+    //changed since the string was summarized
+    if(expanding) {
+        building_expansion.lines.clear();
+        building_expansion.batch = applied;
+
+        SummNode* node = root.findWord(building_expansion.str);
+
+        if(node != 0) node->expand(building_expansion.str, building_expansion.lines, building_expansion.exceptions);
+    }
+}
+
+void Summarizer::finishWork() {
+
+    if(expanding) {
+        ready_expansion.swap(building_expansion);
+        expanding = false;
+    }
+}
+
+void Summarizer::applyOps() {
+
+    size_t no_ops = applying_ops.size();
+
+    for(size_t i=0;i<no_ops;i++) {
+        SummOp& op = applying_ops[i];
+
+        switch(op.type) {
+            case SUMM_OP_ADD: {
+                SummNode* node = root.addWord(node_pool, op.str, 0);
+
+                if(op.handle != 0) {
+                    if(op.handle >= handle_nodes.size()) handle_nodes.resize(op.handle+1, 0);
+                    handle_nodes[op.handle] = node;
+                }
+                break;
+            }
+            case SUMM_OP_REMOVE:
+                handle_nodes[op.handle]->removeWord(node_pool);
+                handle_nodes[op.handle] = 0;
+                break;
+            case SUMM_OP_REMOVE_STRING: {
+                //can only remove as many copies as were added
+                SummNode* node = root.findWord(op.str);
+
+                if(node != 0 && node->ends > 0) {
+                    root.removeWord(node_pool, op.str, 0, std::min(op.count, node->ends));
+                }
+                break;
+            }
+        }
+    }
+
+    applying_ops.clear();
+}
+
+//switch to the latest summary published by the worker thread
+void Summarizer::update() {
+
+    if(!(summ_load(&ready) & SUMM_SNAPSHOT_FRESH)) return;
+
+    front = summ_snapshot(summ_exchange(&ready, (size_t) front));
+
+    strings_changed = true;
+
+    size_t nostrs = front->strings.size();
 
     if(nostrs>1) {
         incrementf  = (((float)display.height-font_gap-top_gap-bottom_gap)/(nostrs-1));
@@ -477,34 +1184,26 @@ void Summarizer::summarize() {
 
 void Summarizer::recalc_display() {
 
+    const std::vector<SummUnit>& strings = front->strings;
+
     size_t nostrs = strings.size();
 
     std::vector<bool> strfound;
     strfound.resize(nostrs, false);
 
-    std::list<SummItem>::iterator it;
+    size_t noitems = items.size();
 
     //update summItems
-    for(it=items.begin();it!=items.end();it++) {
-        SummItem* item = &(*it);
-
-        int match = -1;
+    for(size_t i=0;i<noitems;i++) {
+        SummItem* item = &items[i];
 
-        for(size_t j=0;j<nostrs;j++) {
-            SummUnit summstr = strings[j];
+        int match = front->findString(item->unit.str);
 
-            if(summstr.str.compare(item->unit.str) == 0) {
-                item->updateUnit(summstr);
-
-                match = (int)j;
-
-                strfound[j]= true;
+        if(match!= -1) {
+            if(strings_changed) item->updateUnit(strings[match]);
 
-                break;
-            }
-        }
+            strfound[match] = true;
 
-        if(match!= -1) {
             float destY = calcPosY(match);
             item->setDest(vec2f(pos_x, destY));
         } else {
@@ -518,73 +1217,199 @@ void Summarizer::recalc_display() {
         if(strfound[i]) continue;
 
         float startX = right ? display.width + 100 : -100;
-        float destY  = getPosY(strings[i].str);
+        float destY  = calcPosY(i);
 
-        items.push_back(SummItem(strings[i], vec2f(startX, destY), vec2f(pos_x, destY),pos_x, item_colour, font, showcount));
+        items.push_back(SummItem(strings[i], vec2f(startX, destY), vec2f(pos_x, destY),pos_x, item_colour, &font, showcount));
     }
+
+    strings_changed = false;
 }
 
-void Summarizer::removeString(const std::string& str) {
-    root.removeWord(str,0);
-    changed = true;    
+void Summarizer::queueOp(int type, SummHandle handle, const std::string& str, int count) {
+    queued_ops.push_back(SummOp());
+
+    SummOp& op = queued_ops.back();
+    op.type   = type;
+    op.handle = handle;
+    op.str    = str;
+    op.count  = count;
+}
+
+void Summarizer::removeString(const std::string& str, int count) {
+    if(count <= 0) return;
+
+    queueOp(SUMM_OP_REMOVE_STRING, 0, getKey(str), count);
+}
+
+void Summarizer::removeString(SummHandle handle) {
+    queueOp(SUMM_OP_REMOVE, handle, std::string());
+
+    free_handles.push_back(handle);
 }
 
 float Summarizer::calcPosY(int i) const {
     return top_gap + (incrementf * i) ;
 }
 
-int Summarizer::getBestMatchIndex(const std::string& input) const {
+class SummStringOrder {
+    const std::vector<SummUnit>& strings;
+public:
+    SummStringOrder(const std::vector<SummUnit>& strings) : strings(strings) {}
+
+    bool operator()(int a, int b) const {
+        return strings[a].str < strings[b].str;
+    }
+
+    bool operator()(const std::string& str, int b) const {
+        return str < strings[b].str;
+    }
+};
 
-    int best_diff = -1;
-    int best      = -1;
-    int best_size = -1;
+static size_t summ_common_prefix(const std::string& a, const std::string& b) {
+    size_t n = std::min(a.size(), b.size());
+    size_t i = 0;
+
+    while(i < n && a[i] == b[i]) i++;
+
+    return i;
+}
+
+void SummExpansion::swap(SummExpansion& other) {
+    std::swap(exceptions, other.exceptions);
+    std::swap(batch,      other.batch);
+
+    str.swap(other.str);
+    lines.swap(other.lines);
+}
+
+SummSnapshot::SummSnapshot() {
+    batch = 0;
+}
+
+void SummSnapshot::buildIndex() {
 
     size_t nostrs = strings.size();
 
-    for(size_t i = 0;i < nostrs; i++) {
-        
-        size_t strn_size  = strings[i].str.size();
-        size_t input_size = input.size();
+    sorted_strings.resize(nostrs);
+    sorted_prefix.resize(nostrs);
 
-        int size_diff = strn_size - input_size;
+    for(size_t i=0;i<nostrs;i++) {
+        sorted_strings[i] = i;
+    }
 
-        size_t min_size   = size_diff == 0 ? input_size : std::min ( strn_size, input_size ); 
+    std::sort(sorted_strings.begin(), sorted_strings.end(), SummStringOrder(strings));
 
-        int min_common_diff = abs( strings[i].str.compare(0, min_size, input, 0, min_size) );       
+    //prefixes of a string sort before it, so a stack of the
+    //current string's prefixes gives the longest for each
+    std::vector<int> prefixes;
 
-        //found
-        if(size_diff == 0 && min_common_diff == 0) {
-            best = i;
-            break;
+    for(size_t i=0;i<nostrs;i++) {
+        const std::string& str = strings[sorted_strings[i]].str;
+
+        while(!prefixes.empty()) {
+            const std::string& prefix = strings[sorted_strings[prefixes.back()]].str;
+
+            if(prefix.size() < str.size() && str.compare(0, prefix.size(), prefix) == 0) break;
+
+            prefixes.pop_back();
         }
-        
-        if(    best_diff == -1
-            || min_common_diff < best_diff
-            || (min_common_diff == best_diff //remove this?
-               && min_size > best_size
-               && strn_size < input_size)) {
 
-            best = i;
+        sorted_prefix[i] = prefixes.empty() ? -1 : prefixes.back();
+
+        prefixes.push_back(i);
+    }
+
+    //hash table at most half full
+    size_t table_size = 16;
+    while(table_size < nostrs * 2) table_size *= 2;
 
-            best_diff = min_common_diff;
-            best_size = min_size;
+    string_table.clear();
+    string_table.resize(table_size, -1);
+
+    for(size_t i=0;i<nostrs;i++) {
+        size_t slot = stringHashFNV(strings[i].str) & (table_size-1);
+
+        while(string_table[slot] != -1) {
+            slot = (slot+1) & (table_size-1);
         }
+
+        string_table[slot] = i;
     }
+}
+
+int SummSnapshot::findString(const std::string& str) const {
 
-    return best;
+    size_t table_size = string_table.size();
+
+    if(table_size == 0) return -1;
+
+    size_t slot = stringHashFNV(str) & (table_size-1);
+
+    while(string_table[slot] != -1) {
+        if(strings[string_table[slot]].str == str) return string_table[slot];
+
+        slot = (slot+1) & (table_size-1);
+    }
+
+    return -1;
+}
+
+//index of the longest summary string that is a prefix of the input,
+//or failing that the one sharing the longest prefix with it
+int SummSnapshot::getBestMatchIndex(const std::string& input) const {
+
+    int nostrs = sorted_strings.size();
+
+    if(nostrs == 0) return -1;
+
+    //last string sorting at or before the input
+    int pos = std::upper_bound(sorted_strings.begin(), sorted_strings.end(), input, SummStringOrder(strings)) - sorted_strings.begin() - 1;
+
+    if(pos >= 0) {
+        size_t common = summ_common_prefix(strings[sorted_strings[pos]].str, input);
+
+        //any string that is a prefix of the input is a prefix of this
+        //one too, the first of those short enough is the longest
+        for(int p = pos; p != -1; p = sorted_prefix[p]) {
+            if(strings[sorted_strings[p]].str.size() <= common) return sorted_strings[p];
+        }
+    }
+
+    //no prefix, pick the closer neighbour
+    if(pos+1 >= nostrs) return sorted_strings[pos];
+    if(pos < 0)         return sorted_strings[pos+1];
+
+    size_t before = summ_common_prefix(strings[sorted_strings[pos]].str,   input);
+    size_t after  = summ_common_prefix(strings[sorted_strings[pos+1]].str, input);
+
+    return (after > before) ? sorted_strings[pos+1] : sorted_strings[pos];
+}
+
+int Summarizer::getBestMatchIndex(const std::string& str) const {
+    return front->getBestMatchIndex(getKey(str));
 }
 
 const std::string& Summarizer::getBestMatchStr(const std::string& str) const {
-    int pos = getBestMatchIndex(str);
-        
-    return strings[pos].str;
+    return getStr(getBestMatchIndex(str));
 }
 
+//no strings until the worker has published the first summary
+const std::string& Summarizer::getStr(int i) const {
+    static const std::string none;
+
+    if(i < 0) return none;
+
+    return front->strings[i].str;
+}
 
 float Summarizer::getMiddlePosY(const std::string& str) const {
     return getPosY(str) + (font.getHeight()) / 2;
 }
 
+float Summarizer::calcMiddlePosY(int i) const {
+    return calcPosY(i >= 0 ? i : 0) + (font.getHeight()) / 2;
+}
+
 float Summarizer::getPosY(const std::string& str) const {
 
     int best = getBestMatchIndex(str);
@@ -600,14 +1425,52 @@ void Summarizer::showCount(bool showcount) {
     this->showcount = showcount;
 }
 
-void Summarizer::addString(const std::string& str) {
-    root.addWord(str,0);
-    changed = true;
+void Summarizer::groupAddresses(bool addresses) {
+    this->addresses = addresses;
+}
+
+//strings that are numeric addresses, or masked addresses, are keyed by the
+//address bytes shown rather than the text
+std::string Summarizer::getKey(const std::string& str) const {
+
+    if(!addresses) return str;
+
+    HostAddress address;
+    int prefix_bits;
+
+    if(!address.parsePrefix(str, prefix_bits)) return str;
+
+    std::string key(1 + prefix_bits / 8, '\0');
+
+    key[0] = (address.type == HOST_ADDRESS_IPV4) ? SUMM_KEY_IPV4 : SUMM_KEY_IPV6;
+
+    if(prefix_bits >= 8) memcpy(&key[1], address.bytes, prefix_bits / 8);
+
+    return key;
+}
+
+SummHandle Summarizer::addString(const std::string& str, bool handle) {
+
+    SummHandle id = 0;
+
+    if(handle) {
+        if(!free_handles.empty()) {
+            id = free_handles.back();
+            free_handles.pop_back();
+        } else {
+            id = next_handle++;
+        }
+    }
+
+    queueOp(SUMM_OP_ADD, id, getKey(str));
+
+    return id;
 }
 
 void Summarizer::logic(float dt) {
 
-    if(changed) summarize();
+    summarize();
+    update();
 
     refresh_elapsed+=dt;
     if(refresh_elapsed>=refresh_delay) {
@@ -616,17 +1479,17 @@ void Summarizer::logic(float dt) {
     }
 
     //move items
-    std::list<SummItem>::iterator it;
-    for(it = items.begin();it != items.end(); it++) {
-        (*it).logic(dt);
+    for(size_t i=0;i<items.size();) {
+        items[i].logic(dt);
 
-        if((*it).destroy) {
-            it = items.erase(it);
-            if(it==items.end()) {
-                break;
-            }
+        if(items[i].destroy) {
+            items[i].swap(items.back());
+            items.pop_back();
+            continue;
         }
-    }    
+
+        i++;
+    }
 }
 
 void Summarizer::draw(float dt, float alpha) {
@@ -639,9 +1502,10 @@ void Summarizer::draw(float dt, float alpha) {
         font.draw((int)pos_x, (int)(top_gap - font_gap), title.c_str());
     }
 
-    std::list<SummItem>::iterator it;
-    for(it=items.begin();it!=items.end();it++) {
-        (*it).draw(alpha);
+    size_t noitems = items.size();
+
+    for(size_t i=0;i<noitems;i++) {
+        items[i].draw(alpha);
     }
 
 }
@@ -18,52 +18,109 @@
 #ifndef SUMMARIZER_H
 #define SUMMARIZER_H
 
-#include <list>
+#include <vector>
+
+#include "SDL_thread.h"
 
 #include "core/stringhash.h"
 #include "core/fxfont.h"
 #include "core/regex.h"
 
 #include "textarea.h"
+#include "slabpool.h"
+#include "hostaddress.h"
+
+//fan-out above which a node indexes its children by first byte
+#define SUMM_NODE_INDEX_THRESHOLD 8
+
+//smaller subtrees are summarized again rather than keeping a copy of the result
+#define SUMM_NODE_CACHE_THRESHOLD 16
+
+//first byte of the trie key of a numeric address, followed by the bytes of
+//the address shown, so addresses branch at each octet (/8, /16, /24 ...)
+#define SUMM_KEY_IPV4 '\x01'
+#define SUMM_KEY_IPV6 '\x02'
 
 extern const char* summ_wildcard;
 
+std::string summ_display_string(const std::string& str);
+
 class SummNode;
 
+//summary string copied out of the trie. units are handed to the main thread,
+//so they keep no pointer to the node, which the worker may free at any time
+
 class SummUnit {
 public:
-    SummNode* source;
-
     int words;
     int refs;
     std::string str;
     bool truncated;
     bool exceptions;
 
-    std::vector<std::string> expanded;
+    //number of lines in the expansion, estimated for truncated units
+    int expansions;
 
-    void prependChar(char c);
-    void buildSummary();
+    void prepend(const std::string& prefix);
+    void swap(SummUnit& other);
     SummUnit();
     SummUnit(SummNode* source, bool truncated = false, bool exceptions = false);
 };
 
+//node of a path compressed trie of strings. each node holds the run of
+//characters from its parent, split where strings diverge or end.
+
 class SummNode {
+    SummNode** child_index;
+
+    SummNode* getChild(char c) const;
+    void addChild(SummNode* child);
+    void removeChild(SummNode* child);
+    void replaceChild(SummNode* child, SummNode* replacement);
+
+    SummNode* split(SlabPool& pool, size_t length);
+    void merge(SlabPool& pool);
+
+    //result of the last summarize, reused until something below changes.
+    //only kept by the root and large subtrees that had to be shortened
+    std::vector<SummUnit> summary;
+    int  summary_words;
+    bool changed;
+
+    int summarizeNode(std::vector<SummUnit>& strvec, int no_words);
 public:
     SummNode* parent;
 
     SummNode();
     SummNode(const std::string& str, size_t offset, SummNode* parent);
-    char c;
+    ~SummNode();
+
+    std::string label;
     int words;
     int refs;
-    bool is_root;
+    int ends;
+
+    //childless nodes at or below this node
+    int leaves;
+
+    //last character was first added as the end of a string, which
+    //counts as a word until the node is removed
+    bool created_leaf;
     std::vector<SummNode*> children;
     std::vector<bool> exception;
 
     void debug(int indent = 0);
-    bool addWord(const std::string& str, size_t offset);
-    bool removeWord(const std::string& str, size_t offset);
+    SummNode* addWord(SlabPool& pool, const std::string& str, size_t offset);
+    void removeWord(SlabPool& pool, const std::string& str, size_t offset, int count = 1);
+    void removeWord(SlabPool& pool);
+
+    SummNode* findWord(const std::string& str);
+
+    void clear(SlabPool& pool);
+    void destroy(SlabPool& pool);
+
+    void addLeaves(int delta);
+    int countExpansions() const;
 
     void expand(std::string prefix, std::vector<std::string>& expansion, bool exceptions);
 
@@ -82,7 +139,7 @@ class SummItem {
 
     vec3f* icol;
     bool showcount;
-    FXFont font;
+    FXFont* font;
 public:
     bool departing;
     bool destroy;
@@ -92,6 +149,11 @@ public:
 
     SummUnit unit;
 
+    //tooltip lines, built by the worker thread on first hover and
+    //kept until a later summary is shown
+    std::vector<std::string> expanded;
+    unsigned int expanded_batch;
+
     vec4f colour;
     vec2f pos;
 
@@ -99,15 +161,142 @@ public:
     void logic(float dt);
     void draw(float alpha);
 
-    void updateUnit(SummUnit& unit);
-    SummItem(SummUnit unit, vec2f pos, vec2f dest, float target_x, vec3f* icol, FXFont font, bool showcount);
+    void updateUnit(const SummUnit& unit);
+    void swap(SummItem& other);
+
+    SummItem(const SummUnit& unit, vec2f pos, vec2f dest, float target_x, vec3f* icol, FXFont* font, bool showcount);
 };
 
-class Summarizer {
+//summary strings published by the worker thread, with indexes for lookups
+
+class SummSnapshot {
+public:
     std::vector<SummUnit> strings;
 
-    std::list<SummItem> items;
+    //last batch of changes handed to the worker that the summary includes
+    unsigned int batch;
+
+    //strings in sorted order, and for each the sorted position of the
+    //longest other string that is a prefix of it (or -1)
+    std::vector<int> sorted_strings;
+    std::vector<int> sorted_prefix;
+
+    //open addressed hash table of string indexes
+    std::vector<int> string_table;
+
+    SummSnapshot();
+
+    void buildIndex();
+
+    int findString(const std::string& str) const;
+    int getBestMatchIndex(const std::string& str) const;
+};
+
+//identifies a string added to a summarizer, 0 for none
+typedef unsigned int SummHandle;
+
+enum { SUMM_OP_ADD, SUMM_OP_REMOVE, SUMM_OP_REMOVE_STRING };
+
+//change to the trie waiting to be made by the worker thread
+class SummOp {
+public:
+    int type;
+    SummHandle handle;
+    std::string str;
+
+    //times to remove the string
+    int count;
+};
+
+//tooltip lines for a summary string, built by the worker thread
+class SummExpansion {
+public:
+    std::string str;
+    bool exceptions;
+
+    //batch of changes the trie was at when it was built
+    unsigned int batch;
+
+    std::vector<std::string> lines;
+
+    void swap(SummExpansion& other);
+};
+
+//set on the address of a snapshot published but not yet taken
+#define SUMM_SNAPSHOT_FRESH 1
+
+class Summarizer;
+
+//thread shared by every summarizer, making their changes in turn
+
+class SummWorker {
+    SDL_Thread* thread;
+    SDL_cond* idle;
+
+    std::vector<Summarizer*> summarizers;
+    size_t next;
+
+    //summarizer being worked on without holding mutex
+    Summarizer* busy;
+
+    bool finished;
+
+    Summarizer* findWork();
+public:
+    //held to hand work to the thread, which waits on cond for it
+    SDL_mutex* mutex;
+    SDL_cond* cond;
+
+    SummWorker();
+
+    void add(Summarizer* summarizer);
+    void remove(Summarizer* summarizer);
+
+    void run();
+};
+
+extern SummWorker summ_worker;
+
+class Summarizer {
+    //snapshot in use and the one being built
+    SummSnapshot* front;
+    SummSnapshot* back;
+
+    //address of the latest snapshot published, only changed by an atomic
+    //exchange so neither thread waits on the other to swap snapshots
+    volatile size_t ready;
+
+    std::vector<SummItem> items;
+
+    //strings have been summarized again since items were last updated
+    bool strings_changed;
+
+    //only used by the worker thread
+    SlabPool node_pool;
     SummNode root;
+    std::vector<SummNode*> handle_nodes;
+    std::vector<SummOp> applying_ops;
+    SummExpansion building_expansion;
+    bool expanding;
+
+    //last batch of changes applied
+    unsigned int applied;
+
+    //changes not yet handed to the worker, and those it has not started on
+    std::vector<SummOp> queued_ops;
+    std::vector<SummOp> pending_ops;
+
+    //batches of changes handed to the worker
+    unsigned int submitted;
+
+    //tooltip wanted from the worker, and the last one it built
+    SummExpansion wanted_expansion;
+    bool expansion_wanted;
+
+    SummExpansion ready_expansion;
+
+    std::vector<SummHandle> free_handles;
+    SummHandle next_handle;
 
     vec3f* item_colour;
 
@@ -117,9 +306,9 @@ class Summarizer {
     FXFont font;
 
     bool showcount;
+    bool addresses;
     bool right;
     bool mouseover;
-    bool changed;
     
     float incrementf;
 
@@ -131,6 +320,21 @@ class Summarizer {
     std::string title;
     Regex matchre;
 
+    std::string getKey(const std::string& str) const;
+
+    void queueOp(int type, SummHandle handle, const std::string& str, int count = 1);
+    void applyOps();
+    void update();
+
+    //used by the worker thread, holding its mutex to check for and take
+    //work or hand back the result, but not to do the work itself
+    friend class SummWorker;
+
+    bool hasWork() const;
+    void takeWork();
+    void doWork();
+    void finishWork();
+
 public:
     Summarizer(FXFont font, float x, float top_gap = 0.0f, float bottom_gap = 0.0f, float refresh_delay = 2.0f,
                std::string matchstr = ".*", std::string title="");
@@ -142,13 +346,18 @@ public:
 
     bool isColoured();
     void showCount(bool showcount);
+    void groupAddresses(bool addresses);
     void setColour(vec3f col);
     vec3f getColour();
 
-    bool supportedString(std::string& str);
+    bool supportedString(const std::string& str);
+
+    //handle to remove the string by, or 0 if not wanted
+    SummHandle addString(const std::string& str, bool handle = true);
 
-    void removeString(const std::string& str);
-    void addString(const std::string& str);
+    //remove count copies of a string added without a handle
+    void removeString(const std::string& str, int count = 1);
+    void removeString(SummHandle handle);
 
     const std::string& getBestMatchStr(const std::string& str) const;
     int         getBestMatchIndex(const std::string& str) const;
@@ -156,8 +365,16 @@ public:
     float       getMiddlePosY(const std::string& str) const;
 
     float calcPosY(int i) const;
+    float calcMiddlePosY(int i) const;
+
+    const std::string& getStr(int i) const;
+
+    //hand changes to the worker thread to summarize, returning the
+    //batch the summary must include for them to be shown
+    unsigned int summarize();
 
-    void summarize();
+    //the summary in use includes the changes up to this batch
+    bool isSummarized(unsigned int batch) const { return front->batch >= batch; }
 
     void recalc_display();
     void logic(float dt);
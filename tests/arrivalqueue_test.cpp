@@ -0,0 +1,161 @@
+/*
+    Copyright (C) 2012 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+
+#include "../src/arrivalqueue.h"
+#include "../src/requestball.h"
+
+#include <stdlib.h>
+#include <algorithm>
+
+static RequestBall* new_ball() {
+    LogEntry* le = new LogEntry();
+    le->response_size = 1000;
+
+    return new RequestBall(le, 0, 0, vec3f(1.0f, 1.0f, 1.0f), vec2f(-100.0f, 100.0f), vec2f(800.0f, 200.0f));
+}
+
+//every ball records its own position in the queue
+static bool check_positions(ArrivalQueue& queue, std::vector<RequestBall*>& queued) {
+    for(size_t i=0;i<queued.size();i++) {
+        if(queued[i]->queue != &queue || queued[i]->queue_index >= queue.size()) return false;
+    }
+    return true;
+}
+
+static void test_order() {
+    ArrivalQueue queue;
+
+    TEST_CHECK(queue.empty());
+
+    const double times[] = { 5.0, 1.0, 3.0, 4.0, 2.0 };
+
+    std::vector<RequestBall*> balls;
+
+    for(int i=0;i<5;i++) {
+        balls.push_back(new_ball());
+        queue.push(balls[i], times[i]);
+    }
+
+    TEST_CHECK_EQUAL(queue.size(), 5u);
+    TEST_CHECK(check_positions(queue, balls));
+
+    //taken out early
+    queue.remove(balls[2]);
+    TEST_CHECK(balls[2]->queue == 0);
+
+    TEST_CHECK(queue.top() == balls[1]);
+    queue.pop();
+    TEST_CHECK(balls[1]->queue == 0);
+
+    TEST_CHECK(queue.top() == balls[4]);
+    queue.pop();
+    TEST_CHECK(queue.top() == balls[3]);
+    queue.pop();
+    TEST_CHECK(queue.top() == balls[0]);
+    queue.pop();
+
+    TEST_CHECK(queue.empty());
+
+    //clear lets go of every ball
+    queue.push(balls[0], 1.0);
+    queue.push(balls[1], 2.0);
+    queue.clear();
+
+    TEST_CHECK(queue.empty());
+    TEST_CHECK(balls[0]->queue == 0 && balls[1]->queue == 0);
+
+    for(size_t i=0;i<balls.size();i++) delete balls[i];
+}
+
+//random pushes and removals, popped in order of arrival time
+static void test_random(int seed) {
+    srand(seed);
+
+    ArrivalQueue queue;
+
+    std::vector<RequestBall*> queued;
+    std::vector<double> queued_times;
+
+    int inconsistent = 0;
+    int wrong_top    = 0;
+
+    for(int step=0;step<3000;step++) {
+        int action = rand() % 4;
+
+        if(queued.empty() || action < 2) {
+            RequestBall* ball = new_ball();
+            double time = (rand() % 1000) / 10.0;
+
+            queue.push(ball, time);
+            queued.push_back(ball);
+            queued_times.push_back(time);
+
+        } else if(action == 2) {
+            size_t i = rand() % queued.size();
+
+            queue.remove(queued[i]);
+
+            if(queued[i]->queue != 0) inconsistent++;
+
+            delete queued[i];
+            queued.erase(queued.begin() + i);
+            queued_times.erase(queued_times.begin() + i);
+
+        } else {
+            double soonest = *std::min_element(queued_times.begin(), queued_times.end());
+
+            RequestBall* ball = queue.top();
+
+            size_t i = std::find(queued.begin(), queued.end(), ball) - queued.begin();
+
+            if(i == queued.size() || queued_times[i] != soonest) {
+                wrong_top++;
+                break;
+            }
+
+            queue.pop();
+
+            delete queued[i];
+            queued.erase(queued.begin() + i);
+            queued_times.erase(queued_times.begin() + i);
+        }
+
+        if(queue.size() != queued.size() || !check_positions(queue, queued)) inconsistent++;
+    }
+
+    TEST_CHECK_EQUAL(inconsistent, 0);
+    TEST_CHECK_EQUAL(wrong_top, 0);
+
+    queue.clear();
+
+    for(size_t i=0;i<queued.size();i++) delete queued[i];
+}
+
+int main(int argc, char *argv[]) {
+    display.width  = 1024;
+    display.height = 768;
+
+    test_order();
+
+    for(int seed=1;seed<=5;seed++) {
+        test_random(seed);
+    }
+
+    return test_result();
+}
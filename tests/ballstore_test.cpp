@@ -0,0 +1,198 @@
+/*
+    Copyright (C) 2012 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+
+#include "../src/ballstore.h"
+#include "../src/core/display.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+static float random_float(float low, float high) {
+    return low + (high - low) * (rand() / (float) RAND_MAX);
+}
+
+static void test_fold() {
+    float limit = 768.0f;
+
+    int wrong = 0;
+
+    for(float y = -3000.0f; y <= 3000.0f; y += 0.75f) {
+        float folded = ball_store_fold(y, limit);
+
+        if(folded < 0.0f || folded > limit) wrong++;
+
+        //unchanged on the screen, reflected off the top and bottom
+        if(y >= 0.0f && y <= limit && fabsf(folded - y) > 0.001f) wrong++;
+        if(fabsf(folded - ball_store_fold(-y, limit)) > 0.01f) wrong++;
+        if(fabsf(folded - ball_store_fold(y + limit * 2.0f, limit)) > 0.01f) wrong++;
+    }
+
+    TEST_CHECK_EQUAL(wrong, 0);
+
+    TEST_CHECK(fabsf(ball_store_fold(800.0f, limit) - 736.0f) < 0.001f);
+    TEST_CHECK(fabsf(ball_store_fold(-32.0f, limit) - 32.0f) < 0.001f);
+}
+
+//a ball placed part way along its path that is already on the screen
+//is counted when placed, and not again when it moves
+static void test_offset() {
+    BallStore store;
+    std::vector<ProjectedBall*> arrived;
+
+    int a = store.allocate(0);
+    store.setPath(a, -100.0f, 100.0f, 100.0f, 0.0f);
+    store.speed[a] = 1.0f;
+    store.eta[a]   = 5.0f;
+
+    int b = store.allocate(0);
+    store.setPath(b, -100.0f, 100.0f, 100.0f, 0.0f);
+    store.speed[b] = 1.0f;
+    store.eta[b]   = 5.0f;
+
+    TEST_CHECK_EQUAL(store.getLive(), 2u);
+
+    TEST_CHECK_EQUAL(store.setElapsed(a, 2.0f), 1);
+    TEST_CHECK_EQUAL(store.setElapsed(b, 0.5f), 0);
+
+    //a request merged into a ball counts once it is on the screen
+    TEST_CHECK_EQUAL(store.addWeight(a), 1);
+    TEST_CHECK_EQUAL(store.addWeight(b), 0);
+    TEST_CHECK_EQUAL(store.weight[b], 2);
+
+    TEST_CHECK_EQUAL(store.update(0.25f, arrived), 0);
+    TEST_CHECK_EQUAL(store.update(0.5f, arrived), 2);
+    TEST_CHECK_EQUAL(store.update(5.0f, arrived), 0);
+
+    TEST_CHECK_EQUAL(arrived.size(), 2u);
+
+    store.release(a);
+    store.release(b);
+
+    TEST_CHECK_EQUAL(store.getLive(), 0u);
+
+    //released slots are reused with a weight of one
+    int c = store.allocate(0);
+    TEST_CHECK(c == a || c == b);
+    TEST_CHECK_EQUAL(store.weight[c], 1);
+}
+
+//balls spawned part way along their paths and merged into at random,
+//moved by update and checked against the same movement worked out one
+//ball at a time. every request is counted once when it comes on screen.
+static void test_update(int seed) {
+    srand(seed);
+
+    BallStore store;
+
+    std::vector<ProjectedBall*> arrived;
+
+    //positions worked out without the store
+    std::vector<float> elapsed;
+
+    int counted = 0;
+    int retired = 0;
+
+    int wrong_position = 0;
+    int wrong_arrivals = 0;
+
+    for(int step=0;step<2000;step++) {
+
+        //new balls
+        int spawn = rand() % 4;
+
+        for(int n=0;n<spawn;n++) {
+            int slot = store.allocate(0);
+
+            if(slot >= (int) elapsed.size()) elapsed.resize(store.getSlots(), 0.0f);
+
+            store.setPath(slot, -200.0f, random_float(0.0f, display.height), random_float(50.0f, 300.0f), random_float(-400.0f, 400.0f));
+            store.eta[slot]   = 5.0f;
+            store.speed[slot] = random_float(0.5f, 2.0f);
+
+            elapsed[slot] = random_float(0.0f, 4.0f);
+            counted += store.setElapsed(slot, elapsed[slot]);
+        }
+
+        //merged requests
+        if(store.getLive() > 0 && rand() % 3 == 0) {
+            int slot = rand() % store.getSlots();
+
+            if(store.owners[slot] == 0 && store.speed[slot] > 0.0f) {
+                counted += store.addWeight(slot);
+            }
+        }
+
+        float dt = random_float(0.0f, 0.05f);
+
+        arrived.clear();
+        counted += store.update(dt, arrived);
+
+        int expected_arrivals = 0;
+
+        for(size_t slot=0;slot<store.getSlots();slot++) {
+            if(store.speed[slot] == 0.0f) continue;
+
+            elapsed[slot] += dt * store.speed[slot];
+
+            float x = store.start_x[slot] + store.vx[slot] * elapsed[slot];
+            float y = ball_store_fold(store.start_y[slot] + store.vy[slot] * elapsed[slot], display.height);
+
+            if(fabsf(store.x[slot] - x) > 0.01f || fabsf(store.y[slot] - y) > 0.01f) wrong_position++;
+
+            if(elapsed[slot] >= store.eta[slot]) {
+                expected_arrivals++;
+
+                retired += store.weight[slot];
+                store.release(slot);
+            }
+        }
+
+        if((int) arrived.size() != expected_arrivals) wrong_arrivals++;
+
+        //requests of balls on the screen or gone
+        int on_screen = retired;
+
+        for(size_t slot=0;slot<store.getSlots();slot++) {
+            if(store.speed[slot] > 0.0f && store.x[slot] >= 0.0f) on_screen += store.weight[slot];
+        }
+
+        if(counted != on_screen) {
+            fprintf(stderr, "%s:%d: step %d counted %d requests, %d on the screen\n", __FILE__, __LINE__, step, counted, on_screen);
+            test_failures++;
+            break;
+        }
+    }
+
+    TEST_CHECK_EQUAL(wrong_position, 0);
+    TEST_CHECK_EQUAL(wrong_arrivals, 0);
+}
+
+int main(int argc, char *argv[]) {
+    display.width  = 1024;
+    display.height = 768;
+
+    test_fold();
+    test_offset();
+
+    for(int seed=1;seed<=5;seed++) {
+        test_update(seed);
+    }
+
+    return test_result();
+}
@@ -0,0 +1,115 @@
+/*
+    Copyright (C) 2012 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+
+#include "../src/groupclassifier.h"
+
+//first group whose regex matches, checked one at a time without the prefilter
+static int first_match(std::vector<Regex*>& regexes, const std::string& str) {
+    for(size_t i=0;i<regexes.size();i++) {
+        if(regexes[i]->match(str)) return i;
+    }
+    return -1;
+}
+
+static void test_classify() {
+    GroupClassifier classifier;
+
+    classifier.addGroup("^/images/");
+    classifier.addGroup("\\.(css|js)$");
+    classifier.addGroup("/api/v[0-9]+/");
+    classifier.addGroup("login|logout");
+
+    TEST_CHECK_EQUAL(classifier.size(), 4u);
+
+    TEST_CHECK_EQUAL(classifier.classify("/images/logo.png"), 0);
+    TEST_CHECK_EQUAL(classifier.classify("/static/site.css"), 1);
+    TEST_CHECK_EQUAL(classifier.classify("/api/v2/users"), 2);
+    TEST_CHECK_EQUAL(classifier.classify("/account/logout"), 3);
+    TEST_CHECK_EQUAL(classifier.classify("/index.html"), -1);
+    TEST_CHECK_EQUAL(classifier.classify(""), -1);
+
+    //earlier groups win
+    TEST_CHECK_EQUAL(classifier.classify("/images/login.js"), 0);
+
+    //a literal alone doesn't make a match
+    TEST_CHECK_EQUAL(classifier.classify("/cached/images/"), -1);
+    TEST_CHECK_EQUAL(classifier.classify("/api/vx/"), -1);
+}
+
+static void test_against_regex() {
+    //patterns using the constructs the literal extraction has to understand,
+    //and some it gives up on
+    const char* patterns[] = {
+        "colou?r",
+        "ab*c",
+        "x{0,2}yz",
+        "x{2}yz",
+        "a{b",
+        "\\.php\\?id=",
+        "\\d+\\.jpg",
+        "[a-c]at|dog",
+        "(?i)ADMIN",
+        "(foo|bar)baz",
+        "^/(wp-)?admin",
+        "gr[ae]y",
+        "\\Qa.b\\E",
+        ".*",
+        0
+    };
+
+    const char* urls[] = {
+        "/color", "/colour", "/colr", "/ac", "/abbbc", "/abd",
+        "/yz", "/xyz", "/xxyz", "/a{b", "/page.php?id=3", "/pagephp?id=3",
+        "/12.jpg", "/x.jpg", "/cat", "/hat", "/dog", "/admin", "/ADMIN",
+        "/wp-admin", "/foobaz", "/barbaz", "/baz", "/grey", "/gray",
+        "/a.b", "/axb", "", 0
+    };
+
+    //each pattern on its own, then with all the patterns after it
+    for(int start=0;patterns[start]!=0;start++) {
+
+        GroupClassifier classifier;
+        std::vector<Regex*> regexes;
+
+        for(int i=start;patterns[i]!=0;i++) {
+            classifier.addGroup(patterns[i]);
+            regexes.push_back(new Regex(patterns[i]));
+
+            for(int u=0;urls[u]!=0;u++) {
+                int expected = first_match(regexes, urls[u]);
+                int group    = classifier.classify(urls[u]);
+
+                if(group != expected) {
+                    fprintf(stderr, "%s:%d: '%s' classified as %d, expected %d (groups from '%s')\n",
+                            __FILE__, __LINE__, urls[u], group, expected, patterns[start]);
+                    test_failures++;
+                }
+            }
+        }
+
+        for(size_t i=0;i<regexes.size();i++) delete regexes[i];
+    }
+}
+
+int main(int argc, char *argv[]) {
+    test_classify();
+    test_against_regex();
+
+    return test_result();
+}
@@ -0,0 +1,164 @@
+/*
+    Copyright (C) 2012 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+
+#include "../src/heavyhitters.h"
+
+#include <stdlib.h>
+#include <map>
+
+static std::string host(int i) {
+    char buff[32];
+    snprintf(buff, sizeof(buff), "host%d.example.com", i);
+    return std::string(buff);
+}
+
+static void test_exact() {
+    HeavyHitters hitters(4);
+
+    InternedString evicted;
+    unsigned int evicted_seen = 0;
+
+    //counted exactly while there is room
+    for(int i=0;i<4;i++) {
+        for(int j=0;j<=i;j++) {
+            TEST_CHECK(!hitters.add(InternedString(host(i)), evicted, evicted_seen));
+        }
+    }
+
+    TEST_CHECK_EQUAL(hitters.size(), 4u);
+    TEST_CHECK_EQUAL(hitters.getTotal(), 10u);
+    TEST_CHECK_EQUAL(hitters.getMaxUntracked(), 0u);
+
+    std::vector<InternedString> keys;
+    std::vector<unsigned int> seen;
+    hitters.getTracked(keys, seen);
+
+    TEST_CHECK_EQUAL(keys.size(), 4u);
+
+    for(size_t i=0;i<keys.size();i++) {
+        TEST_CHECK_EQUAL(seen[i], (unsigned int) atoi(keys[i].str().c_str() + 4) + 1);
+    }
+
+    //a new string replaces the lowest
+    TEST_CHECK(hitters.add(InternedString(host(4)), evicted, evicted_seen));
+    TEST_CHECK_STRING(evicted.str(), host(0));
+    TEST_CHECK_EQUAL(evicted_seen, 1u);
+    TEST_CHECK(!hitters.isTracked(InternedString(host(0))));
+    TEST_CHECK(hitters.isTracked(InternedString(host(4))));
+    TEST_CHECK_EQUAL(hitters.getMaxUntracked(), 1u);
+
+    hitters.clear();
+
+    TEST_CHECK_EQUAL(hitters.size(), 0u);
+    TEST_CHECK_EQUAL(hitters.getTotal(), 0u);
+    TEST_CHECK_EQUAL(hitters.getMaxUntracked(), 0u);
+    TEST_CHECK_EQUAL(hitters.estimate(host(3)), 0u);
+}
+
+//skewed stream of hosts checked against exact counts
+static void test_bounds(int seed, size_t capacity) {
+    srand(seed);
+
+    HeavyHitters hitters(capacity);
+
+    std::map<std::string, unsigned int> counts;
+    std::map<std::string, unsigned int> evicted_total;
+
+    int requests = 50000;
+
+    for(int n=0;n<requests;n++) {
+        //half the requests from a few busy hosts
+        int i = (rand() % 2 == 0) ? rand() % 5 : rand() % 2000;
+
+        std::string name = host(i);
+        counts[name]++;
+
+        InternedString evicted;
+        unsigned int evicted_seen = 0;
+
+        if(hitters.add(InternedString(name), evicted, evicted_seen)) {
+            evicted_total[evicted.str()] += evicted_seen;
+        }
+    }
+
+    TEST_CHECK_EQUAL(hitters.getTotal(), (unsigned long) requests);
+    TEST_CHECK_EQUAL(hitters.size(), capacity);
+
+    std::vector<InternedString> keys;
+    std::vector<unsigned int> seen;
+    hitters.getTracked(keys, seen);
+
+    std::map<std::string, unsigned int> tracked;
+
+    unsigned long seen_total = 0;
+    int overcounted = 0;
+
+    for(size_t i=0;i<keys.size();i++) {
+        tracked[keys[i].str()] = seen[i];
+        seen_total += seen[i];
+
+        //counts while tracked never exceed the true count
+        if(seen[i] + evicted_total[keys[i].str()] > counts[keys[i].str()]) overcounted++;
+    }
+
+    TEST_CHECK_EQUAL(overcounted, 0);
+
+    //every request is counted against exactly one string
+    for(std::map<std::string, unsigned int>::iterator it = evicted_total.begin(); it != evicted_total.end(); it++) {
+        seen_total += it->second;
+    }
+
+    TEST_CHECK_EQUAL(seen_total, (unsigned long) requests);
+
+    int untracked_over_bound = 0;
+    int heavy_missed         = 0;
+    int underestimated       = 0;
+
+    for(std::map<std::string, unsigned int>::iterator it = counts.begin(); it != counts.end(); it++) {
+
+        bool is_tracked = tracked.find(it->first) != tracked.end();
+
+        if(!is_tracked && it->second > hitters.getMaxUntracked()) untracked_over_bound++;
+
+        //anything seen more than total/capacity times must be tracked
+        if(!is_tracked && it->second > requests / capacity) heavy_missed++;
+
+        if(hitters.estimate(it->first) < it->second) underestimated++;
+    }
+
+    TEST_CHECK_EQUAL(untracked_over_bound, 0);
+    TEST_CHECK_EQUAL(heavy_missed, 0);
+    TEST_CHECK_EQUAL(underestimated, 0);
+
+    //the busy hosts are all tracked
+    for(int i=0;i<5;i++) {
+        TEST_CHECK(hitters.isTracked(InternedString(host(i))));
+    }
+}
+
+int main(int argc, char *argv[]) {
+    test_exact();
+
+    for(int seed=1;seed<=5;seed++) {
+        test_bounds(seed, 8);
+        test_bounds(seed, 64);
+    }
+
+    return test_result();
+}
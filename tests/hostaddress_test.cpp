@@ -0,0 +1,156 @@
+/*
+    Copyright (C) 2012 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+
+#include "../src/hostaddress.h"
+
+//address in CIDR notation, or an empty string if it did not parse
+static std::string parsed(const std::string& str) {
+    HostAddress address;
+    if(!address.parse(str)) return "";
+
+    return address.cidrString(address.bits());
+}
+
+static void test_parse() {
+    TEST_CHECK_STRING(parsed("192.168.0.1"), "192.168.0.1");
+    TEST_CHECK_STRING(parsed("0.0.0.0"), "0.0.0.0");
+    TEST_CHECK_STRING(parsed("255.255.255.255"), "255.255.255.255");
+
+    TEST_CHECK_STRING(parsed("::1"), "0:0:0:0:0:0:0:1");
+    TEST_CHECK_STRING(parsed("[::1]"), "0:0:0:0:0:0:0:1");
+    TEST_CHECK_STRING(parsed("2001:DB8::8:800:200c:417a"), "2001:db8:0:0:8:800:200c:417a");
+    TEST_CHECK_STRING(parsed("fe80::1%eth0"), "fe80:0:0:0:0:0:0:1");
+
+    //IPv4-mapped addresses are treated as IPv4
+    TEST_CHECK_STRING(parsed("::ffff:10.0.0.1"), "10.0.0.1");
+
+    HostAddress address;
+    TEST_CHECK(address.parse("::ffff:10.0.0.1"));
+    TEST_CHECK_EQUAL(address.type, HOST_ADDRESS_IPV4);
+    TEST_CHECK_EQUAL(address.bits(), 32);
+}
+
+static void test_parse_invalid() {
+    const char* invalid[] = {
+        "",
+        "example.com",
+        "1.2.3",
+        "1.2.3.4.5",
+        "256.1.1.1",
+        "1..2.3",
+        "1.2.3.4 ",
+        "1.2.3.4%x",
+        "1.2.3.4]",
+        "[1.2.3.4]",
+        "1:2:3:4:5:6:7:8:9",
+        "1::2::3",
+        "12345::1",
+        "::g",
+        0
+    };
+
+    for(int i=0;invalid[i]!=0;i++) {
+        HostAddress address;
+
+        if(address.parse(invalid[i])) {
+            fprintf(stderr, "%s:%d: '%s' should not parse\n", __FILE__, __LINE__, invalid[i]);
+            test_failures++;
+        }
+
+        TEST_CHECK_EQUAL(address.type, HOST_ADDRESS_NONE);
+    }
+}
+
+static void test_mask() {
+    HostAddress address;
+
+    TEST_CHECK(address.parse("192.168.123.45"));
+    TEST_CHECK_STRING(address.prefixString(24), "192.168.123-");
+    TEST_CHECK_STRING(address.prefixString(20), "192.168.112-");
+    TEST_CHECK_STRING(address.prefixString(32), "192.168.123.45");
+    TEST_CHECK_STRING(address.cidrString(16), "192.168.0.0/16");
+    TEST_CHECK_STRING(address.cidrString(0), "0.0.0.0/0");
+
+    address.mask(24);
+    TEST_CHECK_STRING(address.cidrString(32), "192.168.123.0");
+
+    TEST_CHECK(address.parse("2001:db8:1234:5::1"));
+    TEST_CHECK_STRING(address.prefixString(48), "2001:db8:1234-");
+    TEST_CHECK_STRING(address.prefixString(64), "2001:db8:1234:5-");
+    TEST_CHECK_STRING(address.prefixString(16), "2001:-");
+    TEST_CHECK_STRING(address.cidrString(32), "2001:db8::/32");
+}
+
+static void test_parse_prefix() {
+    HostAddress address;
+    int bits = 0;
+
+    TEST_CHECK(address.parsePrefix("192.168.0-", bits));
+    TEST_CHECK_EQUAL(bits, 24);
+    TEST_CHECK_STRING(address.cidrString(bits), "192.168.0.0/24");
+
+    TEST_CHECK(address.parsePrefix("10.1.2.3", bits));
+    TEST_CHECK_EQUAL(bits, 32);
+
+    TEST_CHECK(address.parsePrefix("2001:db8:1234-", bits));
+    TEST_CHECK_EQUAL(bits, 48);
+    TEST_CHECK_STRING(address.cidrString(bits), "2001:db8:1234::/48");
+
+    //a single group is still read as IPv6
+    TEST_CHECK(address.parsePrefix("12:-", bits));
+    TEST_CHECK_EQUAL(address.type, HOST_ADDRESS_IPV6);
+    TEST_CHECK_EQUAL(bits, 16);
+
+    TEST_CHECK(address.parsePrefix("12-", bits));
+    TEST_CHECK_EQUAL(address.type, HOST_ADDRESS_IPV4);
+    TEST_CHECK_EQUAL(bits, 8);
+
+    TEST_CHECK(!address.parsePrefix("1.2.3.4-", bits));
+    TEST_CHECK(!address.parsePrefix("2001::1-", bits));
+    TEST_CHECK(!address.parsePrefix("example-", bits));
+
+    //the output of prefixString reads back as the same prefix, for the
+    //prefix lengths the mask options allow short of a full address
+    const char* hosts[] = { "172.16.254.1", "2001:db8:85a3::8a2e:370:7334", 0 };
+
+    for(int i=0;hosts[i]!=0;i++) {
+        TEST_CHECK(address.parse(hosts[i]));
+
+        int step = address.type == HOST_ADDRESS_IPV4 ? 8 : 16;
+
+        for(int prefix=step; prefix < address.bits(); prefix += step) {
+            std::string str = address.prefixString(prefix);
+
+            HostAddress read;
+            int read_bits = 0;
+
+            TEST_CHECK(read.parsePrefix(str, read_bits));
+            TEST_CHECK_STRING(read.prefixString(read_bits), str);
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    test_parse();
+    test_parse_invalid();
+    test_mask();
+    test_parse_prefix();
+
+    return test_result();
+}
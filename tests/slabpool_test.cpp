@@ -0,0 +1,123 @@
+/*
+    Copyright (C) 2012 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+
+#include "../src/slabpool.h"
+
+#include <string.h>
+#include <set>
+
+static void test_pool() {
+    SlabPool pool(24, 8);
+
+    TEST_CHECK_EQUAL(pool.getObjectSize(), 24u);
+    TEST_CHECK_EQUAL(pool.getReserved(), 0u);
+
+    std::vector<char*> objects;
+    std::set<char*> distinct;
+
+    //enough for three slabs
+    for(int i=0;i<20;i++) {
+        char* object = (char*) pool.allocate();
+        memset(object, i, 24);
+
+        objects.push_back(object);
+        distinct.insert(object);
+    }
+
+    TEST_CHECK_EQUAL(distinct.size(), 20u);
+    TEST_CHECK_EQUAL(pool.getLive(), 20u);
+    TEST_CHECK_EQUAL(pool.getReserved(), 3u * 8u * 24u);
+
+    //objects don't overlap
+    int overwritten = 0;
+
+    for(int i=0;i<20;i++) {
+        for(int j=0;j<24;j++) {
+            if(objects[i][j] != i) overwritten++;
+        }
+    }
+
+    TEST_CHECK_EQUAL(overwritten, 0);
+
+    //released objects are handed out again before the slab is extended
+    pool.release(objects[3]);
+    pool.release(objects[11]);
+    pool.release(0);
+
+    TEST_CHECK_EQUAL(pool.getLive(), 18u);
+
+    void* a = pool.allocate();
+    void* b = pool.allocate();
+
+    TEST_CHECK(a == objects[11]);
+    TEST_CHECK(b == objects[3]);
+    TEST_CHECK_EQUAL(pool.getReused(), 2u);
+    TEST_CHECK_EQUAL(pool.getAllocations(), 22u);
+    TEST_CHECK_EQUAL(pool.getReserved(), 3u * 8u * 24u);
+}
+
+static void test_small_objects() {
+    //objects are at least big enough to hold the free list pointer
+    SlabPool pool(1);
+
+    TEST_CHECK(pool.getObjectSize() >= sizeof(void*));
+
+    void* a = pool.allocate();
+    pool.release(a);
+    TEST_CHECK(pool.allocate() == a);
+}
+
+static void test_allocator() {
+    SlabAllocator allocator;
+
+    //sizes in the same size class share a pool
+    void* a = allocator.allocate(17);
+    allocator.release(a, 17);
+    void* b = allocator.allocate(32);
+
+    TEST_CHECK(a == b);
+    TEST_CHECK_EQUAL(allocator.getReused(), 1u);
+
+    //but not with the next size class
+    void* c = allocator.allocate(33);
+    TEST_CHECK(c != b);
+
+    //large sizes come from the heap
+    void* d = allocator.allocate(SLAB_ALLOCATOR_MAX_SIZE + 1);
+    memset(d, 0, SLAB_ALLOCATOR_MAX_SIZE + 1);
+
+    void* e = allocator.allocate(0);
+
+    TEST_CHECK_EQUAL(allocator.getLive(), 3u);
+
+    allocator.release(b, 32);
+    allocator.release(c, 33);
+    allocator.release(d, SLAB_ALLOCATOR_MAX_SIZE + 1);
+    allocator.release(e, 0);
+
+    TEST_CHECK_EQUAL(allocator.getLive(), 0u);
+}
+
+int main(int argc, char *argv[]) {
+    test_pool();
+    test_small_objects();
+    test_allocator();
+
+    return test_result();
+}
@@ -0,0 +1,146 @@
+/*
+    Copyright (C) 2012 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+
+#include "../src/stringtable.h"
+
+#include <map>
+
+static std::string numbered(int i) {
+    char buff[32];
+    snprintf(buff, sizeof(buff), "/page/%d", i);
+    return std::string(buff);
+}
+
+static void test_intern() {
+    StringTable table;
+
+    TEST_CHECK_EQUAL(table.intern(""), 0u);
+    TEST_CHECK_STRING(table.get(0), "");
+    TEST_CHECK_EQUAL(table.size(), 0u);
+
+    unsigned int a = table.intern("example.com");
+    unsigned int b = table.intern("example.org");
+
+    TEST_CHECK(a != 0);
+    TEST_CHECK(a != b);
+    TEST_CHECK_EQUAL(table.intern("example.com"), a);
+    TEST_CHECK_STRING(table.get(a), "example.com");
+    TEST_CHECK_STRING(table.get(b), "example.org");
+    TEST_CHECK_EQUAL(table.size(), 2u);
+}
+
+static void test_release() {
+    StringTable table;
+
+    unsigned int a = table.intern("a");
+    table.acquire(a);
+    unsigned int b = table.intern("b");
+
+    //still referenced once
+    table.release(a);
+    TEST_CHECK_EQUAL(table.size(), 2u);
+    TEST_CHECK_EQUAL(table.intern("a"), a);
+    table.release(a);
+    table.release(a);
+    TEST_CHECK_EQUAL(table.size(), 1u);
+
+    //the freed id is reused for the next new string
+    unsigned int c = table.intern("c");
+    TEST_CHECK_EQUAL(c, a);
+    TEST_CHECK_STRING(table.get(c), "c");
+    TEST_CHECK_STRING(table.get(b), "b");
+
+    //the empty string is never released
+    table.release(0);
+    TEST_CHECK_STRING(table.get(0), "");
+}
+
+static void test_growth() {
+    StringTable table;
+    std::map<std::string, unsigned int> ids;
+
+    //enough strings to rehash several times
+    for(int i=0;i<10000;i++) {
+        ids[numbered(i)] = table.intern(numbered(i));
+    }
+
+    //reference to a string that stays in use throughout
+    const std::string& kept = table.get(ids[numbered(1)]);
+
+    //release every other string and add them again
+    for(int i=0;i<10000;i+=2) {
+        table.release(ids[numbered(i)]);
+    }
+
+    TEST_CHECK_EQUAL(table.size(), 5000u);
+
+    for(int i=0;i<10000;i+=2) {
+        ids[numbered(i)] = table.intern(numbered(i));
+    }
+
+    TEST_CHECK_EQUAL(table.size(), 10000u);
+
+    int wrong = 0;
+
+    for(int i=0;i<10000;i++) {
+        if(table.get(ids[numbered(i)]) != numbered(i)) wrong++;
+        if(table.intern(numbered(i)) != ids[numbered(i)]) wrong++;
+    }
+
+    TEST_CHECK_EQUAL(wrong, 0);
+
+    TEST_CHECK_STRING(kept, numbered(1));
+}
+
+static void test_interned_string() {
+    size_t before = stringtable.size();
+
+    {
+        InternedString a("GET /index.html");
+        InternedString b = a;
+        InternedString c;
+
+        TEST_CHECK(a == b);
+        TEST_CHECK(c.empty());
+        TEST_CHECK(c != a);
+
+        c = std::string("GET /index.html");
+        TEST_CHECK(c == a);
+        TEST_CHECK_STRING(c.str(), "GET /index.html");
+        TEST_CHECK_EQUAL(stringtable.size(), before + 1);
+
+        b = std::string("GET /other.html");
+        TEST_CHECK(b != a);
+        TEST_CHECK_EQUAL(stringtable.size(), before + 2);
+
+        b = a;
+        TEST_CHECK_EQUAL(stringtable.size(), before + 1);
+    }
+
+    TEST_CHECK_EQUAL(stringtable.size(), before);
+}
+
+int main(int argc, char *argv[]) {
+    test_intern();
+    test_release();
+    test_growth();
+    test_interned_string();
+
+    return test_result();
+}
@@ -0,0 +1,397 @@
+/*
+    Copyright (C) 2012 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+
+#include "../src/summarizer.h"
+
+#include <stdlib.h>
+#include <algorithm>
+#include <map>
+
+static const char* parts[] = { "/", "a", "b", "c", "/img", "/img/x", ".png", ".css", "/api/v1/", "users", "1", "12", "123", 0 };
+
+static std::string random_path() {
+    int no_parts = 0;
+    while(parts[no_parts] != 0) no_parts++;
+
+    std::string str;
+    int n = 1 + rand() % 6;
+
+    for(int i=0;i<n;i++) str += parts[rand() % no_parts];
+
+    return str;
+}
+
+static std::string unit_string(const SummUnit& unit) {
+    char buff[64];
+    snprintf(buff, sizeof(buff), "|%d|%d|%d|%d", unit.refs, unit.words, (int) unit.truncated, unit.expansions);
+
+    return unit.str + buff;
+}
+
+//structure that must hold at every node below the root. returns the number of nodes
+static int check_node(SummNode* node, int& bad) {
+
+    int nodes = 1;
+    int refs   = node->ends;
+    int leaves = 0;
+
+    if(node->label.empty()) bad++;
+
+    //nodes are removed once no strings go through them
+    if(node->refs <= 0) bad++;
+
+    //path compression: a node nothing ends at must branch, unless it was
+    //created as the end of a string
+    if(node->ends == 0 && node->children.size() < 2 && !node->created_leaf) bad++;
+
+    for(size_t i=0;i<node->children.size();i++) {
+        SummNode* child = node->children[i];
+
+        if(child->parent != node) bad++;
+
+        for(size_t j=0;j<i;j++) {
+            if(node->children[j]->label[0] == child->label[0]) bad++;
+        }
+
+        refs   += child->refs;
+        leaves += child->leaves;
+        nodes  += check_node(child, bad);
+    }
+
+    if(node->children.empty()) leaves = 1;
+
+    if(refs != node->refs)     bad++;
+    if(leaves != node->leaves) bad++;
+
+    return nodes;
+}
+
+static void check_trie(SummNode& root, SlabPool& pool, std::vector<std::string>& live) {
+
+    int bad   = 0;
+    int nodes = 0;
+
+    for(size_t i=0;i<root.children.size();i++) {
+        if(root.children[i]->parent != &root) bad++;
+        nodes += check_node(root.children[i], bad);
+    }
+
+    TEST_CHECK_EQUAL(bad, 0);
+
+    //every node apart from the root comes from the pool
+    TEST_CHECK_EQUAL((int) pool.getLive(), nodes);
+
+    TEST_CHECK_EQUAL(root.refs, (int) live.size());
+
+    std::map<std::string, int> counts;
+
+    for(size_t i=0;i<live.size();i++) counts[live[i]]++;
+
+    int missing = 0;
+
+    for(std::map<std::string, int>::iterator it = counts.begin(); it != counts.end(); it++) {
+        SummNode* node = root.findWord(it->first);
+
+        if(node == 0 || node->ends != it->second) missing++;
+    }
+
+    TEST_CHECK_EQUAL(missing, 0);
+}
+
+static void test_trie() {
+    SlabPool pool(sizeof(SummNode));
+    SummNode root;
+
+    std::vector<std::string> live;
+
+    const char* words[] = { "/index.html", "/images/a.png", "/images/b.png", "/images", "/index.html", "/about", 0 };
+
+    for(int i=0;words[i]!=0;i++) {
+        root.addWord(pool, words[i], 0);
+        live.push_back(words[i]);
+    }
+
+    check_trie(root, pool, live);
+
+    //strings ending part way through a label, or where no string ends
+    TEST_CHECK(root.findWord("/index") == 0);
+    TEST_CHECK(root.findWord("/images/") != 0 && root.findWord("/images/")->ends == 0);
+    TEST_CHECK(root.findWord("/contact") == 0);
+
+    //every string fits, so each is listed in full
+    std::vector<SummUnit> strvec;
+    root.summarize(strvec, 100);
+
+    std::vector<std::string> listed;
+
+    for(size_t i=0;i<strvec.size();i++) {
+        TEST_CHECK(!strvec[i].truncated);
+        listed.push_back(strvec[i].str);
+
+        if(strvec[i].str == "/index.html") TEST_CHECK_EQUAL(strvec[i].refs, 2);
+    }
+
+    std::sort(listed.begin(), listed.end());
+
+    TEST_CHECK_EQUAL(listed.size(), 4u);
+
+    if(listed.size() == 4) {
+        TEST_CHECK_STRING(listed[0], "/about");
+        TEST_CHECK_STRING(listed[1], "/images/a.png");
+        TEST_CHECK_STRING(listed[2], "/images/b.png");
+        TEST_CHECK_STRING(listed[3], "/index.html");
+    }
+
+    //removing through the node a string ends at
+    root.findWord("/about")->removeWord(pool);
+    live.erase(std::find(live.begin(), live.end(), std::string("/about")));
+
+    root.removeWord(pool, "/images/a.png", 0);
+    live.erase(std::find(live.begin(), live.end(), std::string("/images/a.png")));
+
+    check_trie(root, pool, live);
+
+    //two copies at once
+    root.removeWord(pool, "/index.html", 0, 2);
+    root.removeWord(pool, "/images/b.png", 0);
+    root.removeWord(pool, "/images", 0);
+    live.clear();
+
+    check_trie(root, pool, live);
+
+    TEST_CHECK(root.children.empty());
+    TEST_CHECK_EQUAL(pool.getLive(), 0u);
+}
+
+//change made to a trie, recorded so it can be made again
+struct TrieChange {
+    std::string str;
+    int remove;
+};
+
+static void apply_changes(SummNode& root, SlabPool& pool, const std::vector<TrieChange>& changes) {
+    std::vector<std::string> live;
+
+    for(size_t i=0;i<changes.size();i++) {
+        if(changes[i].remove < 0) {
+            root.addWord(pool, changes[i].str, 0);
+            live.push_back(changes[i].str);
+        } else {
+            root.removeWord(pool, live[changes[i].remove], 0);
+            live.erase(live.begin() + changes[i].remove);
+        }
+    }
+}
+
+//random changes, checking the structure, and that the summaries kept
+//between changes match summarizing a trie built by the same changes
+static void test_random_changes(int seed) {
+    srand(seed);
+
+    SlabPool pool(sizeof(SummNode));
+    SummNode root;
+
+    std::vector<std::string> live;
+    std::vector<TrieChange> changes;
+
+    for(int step=0;step<5000;step++) {
+
+        TrieChange change;
+
+        if(live.empty() || rand() % 3 != 0) {
+            change.str    = random_path();
+            change.remove = -1;
+
+            root.addWord(pool, change.str, 0);
+            live.push_back(change.str);
+        } else {
+            change.remove = rand() % live.size();
+
+            //by string, or through the node it ends at
+            if(rand() % 2 == 0) {
+                root.removeWord(pool, live[change.remove], 0);
+            } else {
+                root.findWord(live[change.remove])->removeWord(pool);
+            }
+
+            live.erase(live.begin() + change.remove);
+        }
+
+        changes.push_back(change);
+
+        if(step % 97 != 0) continue;
+
+        check_trie(root, pool, live);
+
+        int no_words = 5 + rand() % 60;
+
+        std::vector<SummUnit> strvec;
+        root.summarize(strvec, no_words);
+
+        SlabPool fresh_pool(sizeof(SummNode));
+        SummNode fresh;
+
+        apply_changes(fresh, fresh_pool, changes);
+
+        std::vector<SummUnit> fresh_strvec;
+        fresh.summarize(fresh_strvec, no_words);
+
+        int different = (strvec.size() != fresh_strvec.size()) ? 1 : 0;
+
+        for(size_t j=0;j<strvec.size() && j<fresh_strvec.size();j++) {
+            if(unit_string(strvec[j]) != unit_string(fresh_strvec[j])) different++;
+        }
+
+        TEST_CHECK_EQUAL(different, 0);
+
+        fresh.clear(fresh_pool);
+
+        //every string ending at a leaf is covered by a summary string
+        int uncovered = 0;
+
+        for(size_t j=0;j<live.size();j++) {
+            if(!root.findWord(live[j])->children.empty()) continue;
+
+            bool covered = false;
+
+            for(size_t k=0;k<strvec.size() && !covered;k++) {
+                covered = live[j].compare(0, strvec[k].str.size(), strvec[k].str) == 0;
+            }
+
+            if(!covered) uncovered++;
+        }
+
+        TEST_CHECK_EQUAL(uncovered, 0);
+    }
+
+    root.clear(pool);
+    TEST_CHECK_EQUAL(pool.getLive(), 0u);
+}
+
+static size_t common_prefix(const std::string& a, const std::string& b) {
+    size_t i = 0;
+    while(i < a.size() && i < b.size() && a[i] == b[i]) i++;
+    return i;
+}
+
+static void test_snapshot() {
+    SummSnapshot snapshot;
+
+    TEST_CHECK_EQUAL(snapshot.getBestMatchIndex("/index.html"), -1);
+    TEST_CHECK_EQUAL(snapshot.findString("/index.html"), -1);
+
+    const char* strs[] = { "/images/", "/images/icons/", "/index.html", "/api/v1/", "/api/", "/", 0 };
+
+    for(int i=0;strs[i]!=0;i++) {
+        SummUnit unit;
+        unit.str = strs[i];
+        snapshot.strings.push_back(unit);
+    }
+
+    snapshot.buildIndex();
+
+    for(int i=0;strs[i]!=0;i++) {
+        TEST_CHECK_EQUAL(snapshot.findString(strs[i]), i);
+        TEST_CHECK_EQUAL(snapshot.getBestMatchIndex(strs[i]), i);
+    }
+
+    TEST_CHECK_EQUAL(snapshot.findString("/images"), -1);
+
+    //longest prefix
+    TEST_CHECK_EQUAL(snapshot.getBestMatchIndex("/images/icons/home.png"), 1);
+    TEST_CHECK_EQUAL(snapshot.getBestMatchIndex("/images/logo.png"), 0);
+    TEST_CHECK_EQUAL(snapshot.getBestMatchIndex("/api/v2/users"), 4);
+    TEST_CHECK_EQUAL(snapshot.getBestMatchIndex("/about"), 5);
+    TEST_CHECK_EQUAL(snapshot.getBestMatchIndex("/ind"), 5);
+}
+
+//best matches of random strings checked against comparing with every string
+static void test_snapshot_random(int seed) {
+    srand(seed);
+
+    for(int round=0;round<50;round++) {
+        SummSnapshot snapshot;
+
+        std::vector<std::string> strs;
+        int no_strings = rand() % 40;
+
+        for(int i=0;i<no_strings;i++) {
+            std::string str = random_path();
+
+            if(std::find(strs.begin(), strs.end(), str) != strs.end()) continue;
+
+            strs.push_back(str);
+
+            SummUnit unit;
+            unit.str = str;
+            snapshot.strings.push_back(unit);
+        }
+
+        snapshot.buildIndex();
+
+        int wrong = 0;
+
+        for(int n=0;n<200;n++) {
+            std::string input = random_path();
+
+            //longest string that is a prefix of the input, if any
+            int expected = -1;
+            size_t most_common = 0;
+
+            for(size_t i=0;i<strs.size();i++) {
+                if(input.compare(0, strs[i].size(), strs[i]) == 0
+                   && (expected == -1 || strs[i].size() > strs[expected].size())) {
+                    expected = i;
+                }
+
+                most_common = std::max(most_common, common_prefix(strs[i], input));
+            }
+
+            int best = snapshot.getBestMatchIndex(input);
+
+            if(strs.empty()) {
+                if(best != -1) wrong++;
+            } else if(expected != -1) {
+                if(best != expected) wrong++;
+            } else {
+                //any of the strings sharing the most with the input
+                if(best < 0 || common_prefix(strs[best], input) != most_common) wrong++;
+            }
+
+            int found = std::find(strs.begin(), strs.end(), input) - strs.begin();
+            if(found == (int) strs.size()) found = -1;
+
+            if(snapshot.findString(input) != found) wrong++;
+        }
+
+        TEST_CHECK_EQUAL(wrong, 0);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    test_trie();
+    test_snapshot();
+
+    for(int seed=1;seed<=3;seed++) {
+        test_random_changes(seed);
+        test_snapshot_random(seed);
+    }
+
+    return test_result();
+}
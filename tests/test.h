@@ -0,0 +1,52 @@
+/*
+    Copyright (C) 2012 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+#include <string>
+
+//minimal checks for the unit tests under 'make check'. each failed check
+//is reported, and test_result() gives the exit status of the test program.
+
+static int test_failures = 0;
+
+#define TEST_CHECK(expr) \
+    do { \
+        if(!(expr)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); \
+            test_failures++; \
+        } \
+    } while(0)
+
+#define TEST_CHECK_EQUAL(a, b) TEST_CHECK((a) == (b))
+
+#define TEST_CHECK_STRING(str, expected) test_check_string((str), (expected), __FILE__, __LINE__)
+
+static inline void test_check_string(const std::string& str, const std::string& expected, const char* file, int line) {
+    if(str != expected) {
+        fprintf(stderr, "%s:%d: check failed: got '%s', expected '%s'\n", file, line, str.c_str(), expected.c_str());
+        test_failures++;
+    }
+}
+
+static inline int test_result() {
+    return test_failures > 0 ? 1 : 0;
+}
+
+#endif